@@ -28,8 +28,33 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include <unordered_map>
+#include <algorithm>
 #include <functional>
+#include <mutex>
+#include <atomic>
 #include <ctype.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <errno.h>
+#ifdef JSONIC_STATS
+#include <chrono>
+#endif
+#if defined(JSONIC_ZLIB) || defined(JSONIC_ZSTD)
+#include <thread>
+#include <condition_variable>
+#include <deque>
+#include <system_error>
+#endif
+#ifdef JSONIC_ZLIB
+#include <zlib.h>
+#endif
+#ifdef JSONIC_ZSTD
+#include <zstd.h>
+#endif
 
 
 namespace jsonic
@@ -52,6 +77,14 @@ namespace jsonic
 		ValueError
 	};
 
+	// Encoding of the source data of a Member, or the output of BuildNode/Transcode
+	enum Format
+	{
+		FormatJSON=0,
+		FormatMsgPack,
+		FormatCBOR
+	};
+
 
 	struct Value
 	{
@@ -143,15 +176,23 @@ namespace jsonic
 	};
 
 
+	// Small integer id of a key interned in a KeyTable
+	enum KeyId : uint32_t
+	{
+		KeyNone=0
+	};
+
+
 	//
 	// Member is the container for any JSON token - Object, Key, Array and Value
 	// The 'str' and 'len' point to the information in the source string
 	// Use GetValue to convert that information to a value - Null, String, Number, Boolean or Error
+	// For binary formats (MessagePack, CBOR) 'str' and 'len' span the encoded item instead
 	//
 	struct Member
 	{
-		Member() : type(OBJECT) {}
-		Member(char const* sz,size_t szLen) : type(OBJECT),str(sz),len(szLen) {}
+		Member() : type(OBJECT),format(FormatJSON),key(KeyNone),hash(0) {}
+		Member(char const* sz,size_t szLen,Format fmt=FormatJSON) : type(OBJECT),format(fmt),key(KeyNone),str(sz),len(szLen),hash(0) {}
 		Member(Member const& a) { *this = a; }
 		Member& operator=(Member const& a)
 		{
@@ -160,7 +201,11 @@ namespace jsonic
 				str		= a.str;
 				len		= a.len;
 				type	= a.type;
+				format	= a.format;
+				key		= a.key;
+				hash	= a.hash;
 				members	= a.members;
+				values	= a.values;
 			}
 			return *this;
 		}
@@ -168,10 +213,21 @@ namespace jsonic
 
 		// Performs transformations (escape characters, removing quotes, convert to num etc.)
 		Value GetValue() const;
+		Value GetValue(size_t index) const;	// element of an array, including compact arrays
 		bool GetKey(std::string& str) const;
 
+		// Number of elements of an array, or keys of an object
+		size_t Size() const;
+
+		// Decodes a whole array of numbers at once, T is double or int64_t
+		// Fails if this is not an array, an element is not a number (or not an integer for int64_t),
+		// or the buffer holds fewer than Size() elements
+		template<class T> bool GetArray(std::vector<T>& out) const;
+		template<class T> bool GetArray(T* out,size_t capacity,size_t* count) const;
+
 		// Find a child member
 		Member const* Find(char const* sz,size_t szLen=0) const;
+		Member const* Find(KeyId id) const;	// compares ids only, the tree must be parsed with a KeyTable
 		Member const* FindRecursive(char const* sz,size_t szLen) const;
 
 		struct V2
@@ -181,287 +237,1680 @@ namespace jsonic
 		};
 
 		MemberType			type;
+		Format				format;
+		KeyId				key;	// id of a KEY member when parsed with a KeyTable, otherwise KeyNone
 		char const*			str;
 		size_t				len;
+		uint64_t			hash;	// canonical hash of the subtree when parsed with ParseHash, otherwise 0
 		std::vector<Member>	members;
-		std::vector<V2>		values;	// single/array of strings, numbers, bool (empty is null)
+		std::vector<V2>		values;	// elements of a scalar array parsed with ParseCompactArrays
 	};
 
+	template<> bool Member::GetArray<double>(std::vector<double>& out) const;
+	template<> bool Member::GetArray<int64_t>(std::vector<int64_t>& out) const;
+	template<> bool Member::GetArray<double>(double* out,size_t capacity,size_t* count) const;
+	template<> bool Member::GetArray<int64_t>(int64_t* out,size_t capacity,size_t* count) const;
+
 
 	//
 	// Pass in a root member with .str and .len set to valid values
 	// members will contain pointers to the original string (no strings are allocated)
+	// A root constructed with FormatMsgPack or FormatCBOR is read as that binary encoding
 	//
+	enum ParseFlags
+	{
+		ParseDefault	= 0,
+		ParseHash			= 1 << 0,	// set Member::hash on every member, objects hash the same regardless of key order
+		ParseCompactArrays	= 1 << 1	// arrays of only scalars keep their elements as spans in Member::values
+	};
+
 	bool Parse(Member& root);
+	bool Parse(Member& root,int flags);
 
 
 	//
+	// Interns keys across many Parse calls, so repeated keys (e.g. the records of an NDJSON stream)
+	// get the same KeyId and Member::Find(KeyId) compares integers
+	// Lookups are lock free and may run while other threads parse and intern; adding a key takes a lock
+	// The table holds up to 'capacity' distinct keys, further keys are left as KeyNone
 	//
-	//
-	class BuildNode
+	class KeyTable
 	{
 		public:
-		static void PrintNode(BuildNode const& node, std::string& json);
-		
-		BuildNode() : type(MemberType::OBJECT) {}
-		BuildNode(std::string const& key, BuildNode const& value)
+		explicit KeyTable(size_t capacity=4096);
+		~KeyTable();
+
+		// 'sz' is the unescaped key
+		KeyId Intern(char const* sz,size_t len);
+		KeyId Lookup(char const* sz,size_t len=0) const;
+		std::string const* Name(KeyId id) const;
+		size_t Size() const	{ return mCount.load(); }
+
+		private:
+		struct Entry
 		{
-			type	= MemberType::KEY;
-			mKey	= key;
-			nodes.push_back(value);
-		}
-		BuildNode(std::string const& value) : type(MemberType::VALUE)
+			std::string	name;
+			uint64_t	hash;
+			KeyId		id;
+		};
+		KeyTable(KeyTable const&);
+		KeyTable& operator=(KeyTable const&);
+		// Slot of the key, or of the empty slot where it would go
+		size_t Probe(char const* sz,size_t len,uint64_t hash,Entry const** found) const;
+
+		size_t								mCapacity;
+		size_t								mMask;
+		std::atomic<Entry const*>*			mSlots;	// open addressing, at most half full
+		std::atomic<Entry const*>*			mById;
+		std::atomic<size_t>					mCount;
+		std::vector<std::unique_ptr<Entry>>	mEntries;
+		std::mutex							mMutex;
+	};
+
+	// Sets Member::key of every key to its id in 'keys', adding keys that are new
+	bool Parse(Member& root,KeyTable& keys,int flags=ParseDefault);
+
+
+	struct ParseStats;
+#ifdef JSONIC_STATS
+	#define JSONIC_STAT(...)	__VA_ARGS__
+
+	//
+	// Statistics gathered by Parse(root,&stats), only available when JSONIC_STATS is defined
+	// Counts accumulate across calls, so one instance can cover a whole stream of documents
+	//
+	struct ParseStats
+	{
+		size_t		objects			= 0;
+		size_t		arrays			= 0;
+		size_t		keys			= 0;
+		size_t		values			= 0;
+		size_t		maxDepth		= 0;
+		size_t		bytesScanned	= 0;
+		size_t		escapedStrings	= 0;
+		size_t		allocations		= 0;	// growth of the member and depth stack vectors
+		size_t		allocatedBytes	= 0;
+
+		// Phase times in nanoseconds
+		// Timing every member is costly, so scan and build are only timed when 'timePhases' is set
+		// Values are decoded lazily by GetValue, so decoding is only timed when 'decodeValues' is set,
+		// in which case every key and value is decoded once after the tree is built
+		bool		timePhases		= false;
+		bool		decodeValues	= false;
+		uint64_t	scanTime		= 0;
+		uint64_t	buildTime		= 0;
+		uint64_t	decodeTime		= 0;
+
+		// Called for every allocation Parse makes, with its size in bytes
+		std::function<void(size_t)>	onAllocate;
+	};
+
+	bool Parse(Member& root,ParseStats* stats);
+	bool Parse(Member& root,int flags,ParseStats* stats);
+#else
+	#define JSONIC_STAT(...)
+#endif
+
+
+	//
+	// Fixed capacity parsing into caller storage - never allocates or throws
+	// Nodes are written in document order: a container is followed by its subtree and an object holds
+	// KEY, value pairs, so the next sibling of a node is 'size' nodes along
+	// 'str' and 'len' span the token in the source, including quotes and brackets
+	//
+	struct Node
+	{
+		MemberType	type;
+		uint32_t	count;	// keys of an object or elements of an array
+		uint32_t	size;	// nodes in this subtree, including this one
+		char const*	str;
+		size_t		len;
+
+		Node const* Next() const	{ return this + size; }
+
+		// As Member::GetValue and Member::Find, GetValue allocates for strings and Find for keys with escapes
+		Value GetValue() const;
+		Node const* Find(char const* sz,size_t szLen=0) const;
+	};
+
+	struct NodeSpan
+	{
+		Node*		data;
+		size_t		size;
+	};
+
+	struct DepthSpan
+	{
+		uint32_t*	data;	// index of every open container
+		size_t		size;
+	};
+
+	//
+	// Parses src into nodes, with nodes.data[0] as the root and the number of nodes used in 'count'
+	// Fails on a syntax error or when either span is too small
+	// A document of len bytes never needs more than len/2 + 1 nodes or len/2 depth entries
+	//
+	bool Parse(char const* src,size_t len,NodeSpan nodes,DepthSpan depth,size_t* count=nullptr) noexcept;
+
+
+	//
+	// Compares two trees parsed with ParseHash and reports the changed subtrees
+	// Subtrees with equal hashes are skipped without being visited
+	// Trees parsed without ParseHash still compare correctly, but every level is hashed again as it is visited
+	//
+	enum DiffType
+	{
+		DiffAdded=0,
+		DiffRemoved,
+		DiffChanged
+	};
+
+	struct Difference
+	{
+		DiffType		type;
+		std::string		path;	// JSON Pointer to the subtree, e.g. "/items/3/name"
+		Member const*	before;	// nullptr when added, the array itself for elements of compact arrays
+		Member const*	after;	// nullptr when removed, the array itself for elements of compact arrays
+	};
+
+	void Diff(Member const& before,Member const& after,std::vector<Difference>& differences);
+
+
+	//
+	// Columnar extraction from an array of objects, e.g. [{"ts":..,"id":..}, ...]
+	//
+	enum ColumnType
+	{
+		ColumnDouble=0,
+		ColumnInt64,
+		ColumnBoolean,
+		ColumnString
+	};
+
+	//
+	// One field of every row, stored contiguously
+	// Only the vector matching 'type' is filled, with one entry per row (zero or an empty view where 'valid' is clear)
+	// Strings are views of the source between the quotes and keep their escapes, UnescapeString decodes them
+	//
+	struct Column
+	{
+		Column(std::string const& fieldPath,ColumnType columnType) : path(fieldPath),type(columnType),rows(0) {}
+
+		bool IsValid(size_t row) const	{ return ((valid[row / 64] >> (row % 64)) & 1) != 0; }
+
+		std::string				path;	// JSON Pointer into each row, e.g. "/ts" or "/meta/id"
+		ColumnType				type;
+		size_t					rows;
+		std::vector<double>		doubles;
+		std::vector<int64_t>	integers;
+		std::vector<uint8_t>	booleans;
+		std::vector<Member::V2>	strings;
+		std::vector<uint64_t>	valid;	// one bit per row, clear where the field is missing, null or of another type
+	};
+
+	//
+	// Fills every column from the rows of 'array' in one pass
+	// Key positions are taken from the first object and other rows only search for keys that moved
+	// Rows are split across 'threads' threads, 0 uses one per hardware thread
+	// Fails if 'array' is not an array, a path is not a JSON Pointer or a row could not be read (out of memory)
+	//
+	bool ExtractColumns(Member const& array,std::vector<Column>& columns,size_t threads=1);
+
+
+	//
+	// Event driven parsing - no Member tree is built and memory use is proportional to the nesting depth
+	// Derive a handler from EventHandler<Handler> and hide the events of interest; returning false stops the parse
+	// Strings and keys are passed unescaped, pointing into the source when they contain no escapes
+	//
+	template<class Derived>
+	struct EventHandler
+	{
+		bool OnNull()							{ return true; }
+		bool OnBoolean(bool)					{ return true; }
+		bool OnNumber(double)					{ return true; }
+		bool OnInteger(int64_t v)				{ return static_cast<Derived*>(this)->OnNumber((double)v); }	// integers that fit in 64 bits
+		bool OnUnsigned(uint64_t v)				{ return static_cast<Derived*>(this)->OnNumber((double)v); }	// integers above INT64_MAX that fit in 64 bits
+		bool OnString(char const*,size_t)		{ return true; }
+		bool OnKey(char const*,size_t)			{ return true; }
+		bool OnStartObject()					{ return true; }
+		bool OnEndObject()						{ return true; }
+		bool OnStartArray()						{ return true; }
+		bool OnEndArray()						{ return true; }
+		bool OnEndDocument()					{ return true; }	// after each value of an EventStream with 'documents'
+	};
+
+	//
+	// Appends the unescaped form of the inside of JSON quotes to 'out'
+	//
+	inline bool UnescapeString(char const* sz,size_t len,std::string& out)
+	{
+		auto Hex4	= [&](size_t i,uint32_t* code) -> bool
 		{
-			values.push_back(ParseValue(value));
+			if( i+4 > len )	return false;
+			*code	= 0;
+			for( size_t k=i; k<i+4; ++k )
+			{
+				char const c	= sz[k];
+				uint32_t const digit	= (c>='0' && c<='9') ? c-'0' : (c>='a' && c<='f') ? c-'a'+10 : (c>='A' && c<='F') ? c-'A'+10 : 16;
+				if( digit > 15 )	return false;
+				*code	= (*code << 4) | digit;
+			}
+			return true;
+		};
+
+		out.reserve(out.length() + len);
+		for( size_t i=0; i<len; ++i )
+		{
+			// Copy everything up to the next escape at once
+			char const* slash	= (char const*)memchr(sz + i,'\\',len - i);
+			size_t const run	= slash ? slash - (sz + i) : len - i;
+			out.append(sz + i,run);
+			i	+= run;
+			if( i >= len )		break;
+			if( ++i >= len )	return false;
+			char const ch	= sz[i];
+			if( ch=='b' )		out += '\b';
+			else if( ch=='f' )	out += '\f';
+			else if( ch=='n' )	out += '\n';
+			else if( ch=='r' )	out += '\r';
+			else if( ch=='t' )	out += '\t';
+			else if( ch=='u' )
+			{
+				uint32_t code;
+				if( !Hex4(i+1,&code) )	return false;
+				i	+= 4;
+				// Surrogate pair
+				uint32_t low;
+				if( code>=0xd800 && code<=0xdbff && i+6<len && sz[i+1]=='\\' && sz[i+2]=='u' && Hex4(i+3,&low) && low>=0xdc00 && low<=0xdfff )
+				{
+					code	= 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+					i		+= 6;
+				}
+				// Same encoding as UTF32toUTF8Char
+				if( code < 0x80 )
+				{
+					out	+= (char)code;
+				}
+				else if( code < 0x800 )
+				{
+					out	+= (char)(0xc0 | (code >> 6));
+					out	+= (char)(0x80 | (code & 0x3f));
+				}
+				else if( code < 0x10000 )
+				{
+					out	+= (char)(0xe0 | (code >> 12));
+					out	+= (char)(0x80 | ((code >> 6) & 0x3f));
+					out	+= (char)(0x80 | (code & 0x3f));
+				}
+				else
+				{
+					out	+= (char)(0xf0 | (code >> 18));
+					out	+= (char)(0x80 | ((code >> 12) & 0x3f));
+					out	+= (char)(0x80 | ((code >> 6) & 0x3f));
+					out	+= (char)(0x80 | (code & 0x3f));
+				}
+			}
+			else
+			{
+				// Quote("), Backslash(\), and Forward-slash(/) are already set once the escape character is removed
+				out	+= ch;
+			}
 		}
-		BuildNode(int value) : type(MemberType::VALUE)
+		return true;
+	}
+
+	//
+	// Number decoding
+	// Runs of eight digits are combined at once with SWAR arithmetic, and doubles with at most 19
+	// significant digits and a small exponent are exact with one multiply or divide (Clinger's fast path)
+	// Longer mantissas, such as those printed with %.17g, are rounded with Eisel-Lemire
+	// Everything else falls back to strtod
+	//
+	inline bool IsEightDigits(char const* sz)
+	{
+		uint64_t v;
+		memcpy(&v,sz,8);
+		return (((v & 0xf0f0f0f0f0f0f0f0ULL) | (((v + 0x0606060606060606ULL) & 0xf0f0f0f0f0f0f0f0ULL) >> 4)) == 0x3333333333333333ULL);
+	}
+	inline uint32_t ParseEightDigits(char const* sz)
+	{
+		uint64_t v;
+		memcpy(&v,sz,8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+		v	= __builtin_bswap64(v);
+#endif
+		v	-= 0x3030303030303030ULL;
+		v	= (v * 10) + (v >> 8);
+		v	= (((v & 0x000000ff000000ffULL) * 0x000f424000000064ULL) + (((v >> 16) & 0x000000ff000000ffULL) * 0x0000271000000001ULL)) >> 32;
+		return (uint32_t)v;
+	}
+
+	// Reads digits into 'mantissa' while it stays below 10^19, returns the number of digits read
+	inline size_t ParseDigits(char const*& p,char const* end,uint64_t& mantissa,size_t& digits)
+	{
+		char const* begin	= p;
+		while( end-p >= 8 && digits+8 <= 19 && IsEightDigits(p) )
 		{
-			values.push_back(std::to_string(value));
+			mantissa	= mantissa*100000000 + ParseEightDigits(p);
+			digits		+= mantissa ? 8 : 0;
+			p			+= 8;
 		}
-		BuildNode(double value) : type(MemberType::VALUE)
+		while( p<end && *p>='0' && *p<='9' )
 		{
-			values.push_back(std::to_string(value));
+			if( digits < 19 )
+			{
+				mantissa	= mantissa*10 + (*p - '0');
+				digits		+= mantissa ? 1 : 0;
+			}
+			else
+			{
+				digits	= 20;	// too many for the fast path
+			}
+			++p;
 		}
-		BuildNode(bool value) : type(MemberType::VALUE)
+		return p - begin;
+	}
+	// JSON allows no leading zeros, '0' must be the whole integer part
+	inline bool IsLeadingZero(char const* p,size_t digits)
+	{
+		return digits > 1 && *p == '0';
+	}
+
+	//
+	// Parses the whole of sz as an integer, fails on anything else or overflow
+	//
+	inline bool ParseInteger(char const* sz,size_t len,int64_t* out)
+	{
+		char const* p	= sz;
+		char const* end	= sz + len;
+		bool const neg	= p<end && *p=='-';
+		if( neg )	++p;
+		char const* first	= p;
+		uint64_t mantissa	= 0;
+		size_t digits		= 0;
+		size_t const n		= ParseDigits(p,end,mantissa,digits);
+		if( n == 0 || p != end || digits > 19 || IsLeadingZero(first,n) )
 		{
-			values.push_back(value ? "true" : "false");
+			return false;
 		}
-		BuildNode(nullptr_t) : type(MemberType::VALUE)
+		if( mantissa > (uint64_t)INT64_MAX + (neg ? 1 : 0) )
 		{
-			values.push_back("null");
+			return false;
 		}
-		BuildNode(std::vector<BuildNode> const& list) : type(MemberType::ARRAY)
+		*out	= neg ? (int64_t)(0 - mantissa) : (int64_t)mantissa;
+		return true;
+	}
+
+	//
+	// Parses the whole of sz as a non-negative integer, fails on anything else or overflow
+	//
+	inline bool ParseUnsigned(char const* sz,size_t len,uint64_t* out)
+	{
+		if( len == 0 || len > 20 || IsLeadingZero(sz,len) )	return false;
+		uint64_t value	= 0;
+		for( size_t i=0; i<len; ++i )
 		{
-			nodes = list;
+			if( sz[i]<'0' || sz[i]>'9' )	return false;
+			uint64_t const digit	= sz[i] - '0';
+			if( value > (UINT64_MAX - digit) / 10 )	return false;
+			value	= value*10 + digit;
 		}
-		BuildNode(std::vector<std::string> const& list) : type(MemberType::ARRAY)
+		*out	= value;
+		return true;
+	}
+
+	inline void Multiply128(uint64_t a,uint64_t b,uint64_t& high,uint64_t& low)
+	{
+#if defined(__SIZEOF_INT128__)
+		unsigned __int128 const r	= (unsigned __int128)a * b;
+		high	= (uint64_t)(r >> 64);
+		low		= (uint64_t)r;
+#else
+		uint64_t const ll		= (a & 0xffffffff) * (b & 0xffffffff);
+		uint64_t const lh		= (a & 0xffffffff) * (b >> 32);
+		uint64_t const hl		= (a >> 32) * (b & 0xffffffff);
+		uint64_t const middle	= (ll >> 32) + (lh & 0xffffffff) + (hl & 0xffffffff);
+		low		= (middle << 32) | (ll & 0xffffffff);
+		high	= (a >> 32) * (b >> 32) + (lh >> 32) + (hl >> 32) + (middle >> 32);
+#endif
+	}
+
+	//
+	// Rounds mantissa * 10^exponent correctly from a 128-bit approximation of 5^exponent
+	// Fails when the approximation cannot decide the rounding, outside the table and for subnormals or infinity
+	//
+	inline bool EiselLemire(uint64_t mantissa,int64_t exponent,bool neg,double* out)
+	{
+		// 5^q for q from -64 to 64, normalized and truncated to 128 bits, high word first
+		static const int64_t first		= -64;
+		static const uint64_t powers[]	= {
+			0xa87fea27a539e9a5ULL, 0x3f2398d747b36224ULL, 0xd29fe4b18e88640eULL, 0x8eec7f0d19a03aadULL,
+			0x83a3eeeef9153e89ULL, 0x1953cf68300424acULL, 0xa48ceaaab75a8e2bULL, 0x5fa8c3423c052dd7ULL,
+			0xcdb02555653131b6ULL, 0x3792f412cb06794dULL, 0x808e17555f3ebf11ULL, 0xe2bbd88bbee40bd0ULL,
+			0xa0b19d2ab70e6ed6ULL, 0x5b6aceaeae9d0ec4ULL, 0xc8de047564d20a8bULL, 0xf245825a5a445275ULL,
+			0xfb158592be068d2eULL, 0xeed6e2f0f0d56712ULL, 0x9ced737bb6c4183dULL, 0x55464dd69685606bULL,
+			0xc428d05aa4751e4cULL, 0xaa97e14c3c26b886ULL, 0xf53304714d9265dfULL, 0xd53dd99f4b3066a8ULL,
+			0x993fe2c6d07b7fabULL, 0xe546a8038efe4029ULL, 0xbf8fdb78849a5f96ULL, 0xde98520472bdd033ULL,
+			0xef73d256a5c0f77cULL, 0x963e66858f6d4440ULL, 0x95a8637627989aadULL, 0xdde7001379a44aa8ULL,
+			0xbb127c53b17ec159ULL, 0x5560c018580d5d52ULL, 0xe9d71b689dde71afULL, 0xaab8f01e6e10b4a6ULL,
+			0x9226712162ab070dULL, 0xcab3961304ca70e8ULL, 0xb6b00d69bb55c8d1ULL, 0x3d607b97c5fd0d22ULL,
+			0xe45c10c42a2b3b05ULL, 0x8cb89a7db77c506aULL, 0x8eb98a7a9a5b04e3ULL, 0x77f3608e92adb242ULL,
+			0xb267ed1940f1c61cULL, 0x55f038b237591ed3ULL, 0xdf01e85f912e37a3ULL, 0x6b6c46dec52f6688ULL,
+			0x8b61313bbabce2c6ULL, 0x2323ac4b3b3da015ULL, 0xae397d8aa96c1b77ULL, 0xabec975e0a0d081aULL,
+			0xd9c7dced53c72255ULL, 0x96e7bd358c904a21ULL, 0x881cea14545c7575ULL, 0x7e50d64177da2e54ULL,
+			0xaa242499697392d2ULL, 0xdde50bd1d5d0b9e9ULL, 0xd4ad2dbfc3d07787ULL, 0x955e4ec64b44e864ULL,
+			0x84ec3c97da624ab4ULL, 0xbd5af13bef0b113eULL, 0xa6274bbdd0fadd61ULL, 0xecb1ad8aeacdd58eULL,
+			0xcfb11ead453994baULL, 0x67de18eda5814af2ULL, 0x81ceb32c4b43fcf4ULL, 0x80eacf948770ced7ULL,
+			0xa2425ff75e14fc31ULL, 0xa1258379a94d028dULL, 0xcad2f7f5359a3b3eULL, 0x096ee45813a04330ULL,
+			0xfd87b5f28300ca0dULL, 0x8bca9d6e188853fcULL, 0x9e74d1b791e07e48ULL, 0x775ea264cf55347eULL,
+			0xc612062576589ddaULL, 0x95364afe032a819eULL, 0xf79687aed3eec551ULL, 0x3a83ddbd83f52205ULL,
+			0x9abe14cd44753b52ULL, 0xc4926a9672793543ULL, 0xc16d9a0095928a27ULL, 0x75b7053c0f178294ULL,
+			0xf1c90080baf72cb1ULL, 0x5324c68b12dd6339ULL, 0x971da05074da7beeULL, 0xd3f6fc16ebca5e04ULL,
+			0xbce5086492111aeaULL, 0x88f4bb1ca6bcf585ULL, 0xec1e4a7db69561a5ULL, 0x2b31e9e3d06c32e6ULL,
+			0x9392ee8e921d5d07ULL, 0x3aff322e62439fd0ULL, 0xb877aa3236a4b449ULL, 0x09befeb9fad487c3ULL,
+			0xe69594bec44de15bULL, 0x4c2ebe687989a9b4ULL, 0x901d7cf73ab0acd9ULL, 0x0f9d37014bf60a11ULL,
+			0xb424dc35095cd80fULL, 0x538484c19ef38c95ULL, 0xe12e13424bb40e13ULL, 0x2865a5f206b06fbaULL,
+			0x8cbccc096f5088cbULL, 0xf93f87b7442e45d4ULL, 0xafebff0bcb24aafeULL, 0xf78f69a51539d749ULL,
+			0xdbe6fecebdedd5beULL, 0xb573440e5a884d1cULL, 0x89705f4136b4a597ULL, 0x31680a88f8953031ULL,
+			0xabcc77118461cefcULL, 0xfdc20d2b36ba7c3eULL, 0xd6bf94d5e57a42bcULL, 0x3d32907604691b4dULL,
+			0x8637bd05af6c69b5ULL, 0xa63f9a49c2c1b110ULL, 0xa7c5ac471b478423ULL, 0x0fcf80dc33721d54ULL,
+			0xd1b71758e219652bULL, 0xd3c36113404ea4a9ULL, 0x83126e978d4fdf3bULL, 0x645a1cac083126eaULL,
+			0xa3d70a3d70a3d70aULL, 0x3d70a3d70a3d70a4ULL, 0xccccccccccccccccULL, 0xcccccccccccccccdULL,
+			0x8000000000000000ULL, 0x0000000000000000ULL, 0xa000000000000000ULL, 0x0000000000000000ULL,
+			0xc800000000000000ULL, 0x0000000000000000ULL, 0xfa00000000000000ULL, 0x0000000000000000ULL,
+			0x9c40000000000000ULL, 0x0000000000000000ULL, 0xc350000000000000ULL, 0x0000000000000000ULL,
+			0xf424000000000000ULL, 0x0000000000000000ULL, 0x9896800000000000ULL, 0x0000000000000000ULL,
+			0xbebc200000000000ULL, 0x0000000000000000ULL, 0xee6b280000000000ULL, 0x0000000000000000ULL,
+			0x9502f90000000000ULL, 0x0000000000000000ULL, 0xba43b74000000000ULL, 0x0000000000000000ULL,
+			0xe8d4a51000000000ULL, 0x0000000000000000ULL, 0x9184e72a00000000ULL, 0x0000000000000000ULL,
+			0xb5e620f480000000ULL, 0x0000000000000000ULL, 0xe35fa931a0000000ULL, 0x0000000000000000ULL,
+			0x8e1bc9bf04000000ULL, 0x0000000000000000ULL, 0xb1a2bc2ec5000000ULL, 0x0000000000000000ULL,
+			0xde0b6b3a76400000ULL, 0x0000000000000000ULL, 0x8ac7230489e80000ULL, 0x0000000000000000ULL,
+			0xad78ebc5ac620000ULL, 0x0000000000000000ULL, 0xd8d726b7177a8000ULL, 0x0000000000000000ULL,
+			0x878678326eac9000ULL, 0x0000000000000000ULL, 0xa968163f0a57b400ULL, 0x0000000000000000ULL,
+			0xd3c21bcecceda100ULL, 0x0000000000000000ULL, 0x84595161401484a0ULL, 0x0000000000000000ULL,
+			0xa56fa5b99019a5c8ULL, 0x0000000000000000ULL, 0xcecb8f27f4200f3aULL, 0x0000000000000000ULL,
+			0x813f3978f8940984ULL, 0x4000000000000000ULL, 0xa18f07d736b90be5ULL, 0x5000000000000000ULL,
+			0xc9f2c9cd04674edeULL, 0xa400000000000000ULL, 0xfc6f7c4045812296ULL, 0x4d00000000000000ULL,
+			0x9dc5ada82b70b59dULL, 0xf020000000000000ULL, 0xc5371912364ce305ULL, 0x6c28000000000000ULL,
+			0xf684df56c3e01bc6ULL, 0xc732000000000000ULL, 0x9a130b963a6c115cULL, 0x3c7f400000000000ULL,
+			0xc097ce7bc90715b3ULL, 0x4b9f100000000000ULL, 0xf0bdc21abb48db20ULL, 0x1e86d40000000000ULL,
+			0x96769950b50d88f4ULL, 0x1314448000000000ULL, 0xbc143fa4e250eb31ULL, 0x17d955a000000000ULL,
+			0xeb194f8e1ae525fdULL, 0x5dcfab0800000000ULL, 0x92efd1b8d0cf37beULL, 0x5aa1cae500000000ULL,
+			0xb7abc627050305adULL, 0xf14a3d9e40000000ULL, 0xe596b7b0c643c719ULL, 0x6d9ccd05d0000000ULL,
+			0x8f7e32ce7bea5c6fULL, 0xe4820023a2000000ULL, 0xb35dbf821ae4f38bULL, 0xdda2802c8a800000ULL,
+			0xe0352f62a19e306eULL, 0xd50b2037ad200000ULL, 0x8c213d9da502de45ULL, 0x4526f422cc340000ULL,
+			0xaf298d050e4395d6ULL, 0x9670b12b7f410000ULL, 0xdaf3f04651d47b4cULL, 0x3c0cdd765f114000ULL,
+			0x88d8762bf324cd0fULL, 0xa5880a69fb6ac800ULL, 0xab0e93b6efee0053ULL, 0x8eea0d047a457a00ULL,
+			0xd5d238a4abe98068ULL, 0x72a4904598d6d880ULL, 0x85a36366eb71f041ULL, 0x47a6da2b7f864750ULL,
+			0xa70c3c40a64e6c51ULL, 0x999090b65f67d924ULL, 0xd0cf4b50cfe20765ULL, 0xfff4b4e3f741cf6dULL,
+			0x82818f1281ed449fULL, 0xbff8f10e7a8921a4ULL, 0xa321f2d7226895c7ULL, 0xaff72d52192b6a0dULL,
+			0xcbea6f8ceb02bb39ULL, 0x9bf4f8a69f764490ULL, 0xfee50b7025c36a08ULL, 0x02f236d04753d5b4ULL,
+			0x9f4f2726179a2245ULL, 0x01d762422c946590ULL, 0xc722f0ef9d80aad6ULL, 0x424d3ad2b7b97ef5ULL,
+			0xf8ebad2b84e0d58bULL, 0xd2e0898765a7deb2ULL, 0x9b934c3b330c8577ULL, 0x63cc55f49f88eb2fULL,
+			0xc2781f49ffcfa6d5ULL, 0x3cbf6b71c76b25fbULL };
+		if( mantissa == 0 || exponent < first || exponent > first + (int64_t)(sizeof(powers) / sizeof(powers[0]) / 2) - 1 )
 		{
-			for( std::string const& v : list )
-			{
-				values.push_back(ParseValue(v));
-			}
+			return false;
 		}
-		BuildNode(std::vector<int> const& list) : type(MemberType::ARRAY)
+		int lz	= 0;
+		while( (mantissa << lz) >> 63 == 0 )	++lz;
+		uint64_t const w	= mantissa << lz;
+		size_t const index	= (size_t)(exponent - first) * 2;
+
+		uint64_t high, low;
+		Multiply128(w,powers[index],high,low);
+		if( (high & 0x1ff) == 0x1ff )
 		{
-			for( int v : list )
-			{
-				values.push_back(std::to_string(v));
-			}
+			// The bits that decide rounding may carry, so bring in the low word of the power
+			uint64_t high2, low2;
+			Multiply128(w,powers[index + 1],high2,low2);
+			low	+= high2;
+			if( high2 > low )	++high;
+			if( low == UINT64_MAX && (exponent < -27 || exponent > 55) )	return false;
 		}
-		BuildNode(std::vector<double> const& list) : type(MemberType::ARRAY)
+
+		int const upperBit	= (int)(high >> 63);
+		uint64_t m			= high >> (upperBit + 9);
+		int64_t power2		= ((217706 * exponent) >> 16) + 63 + upperBit - lz + 1023;
+		if( power2 <= 0 )	return false;
+		// A product that is exactly halfway between two doubles rounds to even
+		if( low <= 1 && exponent >= -4 && exponent <= 23 && (m & 3) == 1 && (m << (upperBit + 9)) == high )
 		{
-			for( double v : list )
-			{
-				values.push_back(std::to_string(v));
-			}
+			m	&= ~(uint64_t)1;
 		}
-		BuildNode(std::initializer_list<BuildNode> const& list) : type(MemberType::ARRAY)
+		m	+= m & 1;
+		m	>>= 1;
+		if( m >= ((uint64_t)2 << 52) )
 		{
-			nodes = list;
+			m	= (uint64_t)1 << 52;
+			++power2;
 		}
-		BuildNode(std::initializer_list<char const*> const& list) : type(MemberType::ARRAY)
+		m	&= ~((uint64_t)1 << 52);
+		if( power2 >= 0x7ff )	return false;
+
+		uint64_t const bits	= m | ((uint64_t)power2 << 52) | ((uint64_t)neg << 63);
+		memcpy(out,&bits,sizeof(bits));
+		return true;
+	}
+
+	//
+	// Parses the whole of sz as a JSON number, fails on anything else
+	//
+	inline bool ParseDouble(char const* sz,size_t len,double* out)
+	{
+		static const double powers[]	= { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+											1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+		char const* p	= sz;
+		char const* end	= sz + len;
+		bool const neg	= p<end && *p=='-';
+		if( neg )	++p;
+
+		char const* first	= p;
+		uint64_t mantissa	= 0;
+		size_t digits		= 0;
+		int64_t exponent	= 0;
+		size_t const whole	= ParseDigits(p,end,mantissa,digits);
+		if( whole == 0 || IsLeadingZero(first,whole) )	return false;
+		if( p<end && *p=='.' )
 		{
-			for( char const* v : list )
-			{
-				values.push_back(ParseValue(v));
-			}
+			++p;
+			// Every fraction digit scales the mantissa, including leading zeros
+			size_t const n	= ParseDigits(p,end,mantissa,digits);
+			if( n == 0 )	return false;
+			exponent	-= (int64_t)n;
 		}
-		BuildNode(std::initializer_list<std::string> const& list) : type(MemberType::ARRAY)
+		if( p<end && (*p=='e' || *p=='E') )
 		{
-			for( std::string const& v : list )
+			++p;
+			bool const negExp	= p<end && *p=='-';
+			if( p<end && (*p=='-' || *p=='+') )	++p;
+			if( p>=end || *p<'0' || *p>'9' )	return false;
+			int64_t e	= 0;
+			while( p<end && *p>='0' && *p<='9' )
 			{
-				values.push_back(ParseValue(v));
+				if( e < 100000 )	e = e*10 + (*p - '0');
+				++p;
 			}
+			exponent	+= negExp ? -e : e;
 		}
-		BuildNode(std::initializer_list<int> const& list) : type(MemberType::ARRAY)
+		if( p != end )	return false;
+
+		if( digits <= 19 && mantissa <= ((uint64_t)1 << 53) && exponent >= -22 && exponent <= 22 )
 		{
-			for( int v : list )
-			{
-				values.push_back(std::to_string(v));
-			}
+			double d	= (double)mantissa;
+			d	= exponent < 0 ? d / powers[-exponent] : d * powers[exponent];
+			*out	= neg ? -d : d;
+			return true;
 		}
-		BuildNode(std::initializer_list<double> const& list) : type(MemberType::ARRAY)
+		if( digits <= 19 && EiselLemire(mantissa,exponent,neg,out) )
 		{
-			for( double v : list )
-			{
-				values.push_back(std::to_string(v));
-			}
+			return true;
 		}
 
-		void AddNode(std::string const& key, BuildNode const& value)
+		// strtod needs a terminated copy, the source may not be
+		char local[64];
+		std::string large;
+		char const* text	= local;
+		if( len < sizeof(local) )
 		{
-			nodes.push_back(BuildNode(key, value));
+			memcpy(local,sz,len);
+			local[len]	= '\0';
 		}
-
-		private:
-		std::string ParseValue(std::string const& str) const
+		else
 		{
-			std::string result;
-			result	+= '\"';
-			for( char ch : str )
-			{
-				if( ch == '\\' )		{ result += "\\\\"; }
-				else if( ch == '/' )	{ result += "\\/"; }
-				else if( ch == '\"' )	{ result += "\\\""; }
-				else if( ch == '\b' )	{ result += "\\b"; }
-				else if( ch == '\f' )	{ result += "\\f"; }
-				else if( ch == '\n' )	{ result += "\\n"; }
-				else if( ch == '\r' )	{ result += "\\r"; }
-				else if( ch == '\t' )	{ result += "\\t"; }
-				else					{ result += ch;	}
-			}
-			result += '\"';
-			return result;
+			large.assign(sz,len);
+			text	= large.c_str();
 		}
-		MemberType					type;
-		std::string					mKey;
-		std::vector<std::string>	values;
-		std::vector<BuildNode>		nodes;
-	};
-	
-};
+		// Out of range is not a number here, so GetValue reports it as an error
+		// Subnormals also set ERANGE but are kept
+		errno	= 0;
+		double const d	= strtod(text,nullptr);
+		if( errno == ERANGE && (d == 0 || d == HUGE_VAL || d == -HUGE_VAL) )	return false;
+		*out	= d;
+		return true;
+	}
 
+	template<class Handler>
+	bool ParseEvents(char const* src,size_t len,Handler& handler)
+	{
+		if( src == nullptr )	return false;
 
-#ifdef JSONIC_IMPLEMENTATION
+		std::vector<char>	stack;	// '{' or '[' for each open container
+		std::string			buffer;	// reused for strings with escapes
+		char const* psz		= src;
+		char const* end		= src + len;
 
-namespace jsonic
-{
-	// String utility functions would be useful in their own header, however, in keeping with a single header library...
-	
-	//
-	// Returns the number of bytes required to encode the character
-	//
-	inline int UTF8CharLength(char ch)
-	{
-		uint8_t const c	= (uint8_t)ch;
-		if( c <= 127 )				return 1;
-		if( (c & 0xe0) == 0xc0 )	return 2;
-		if( (c & 0xf0) == 0xe0 )	return 3;
-		if( (c & 0xf8) == 0xf0 )	return 4;
-		return 1;
-	}
-	inline int UTF32toUTF8Length(uint32_t ch)
-	{
-		constexpr uint32_t maxLegalUTF32 = 0x0010FFFF;
-		if( ch < (uint32_t)0x80 )		return 1;
-		if( ch < (uint32_t)0x800 )		return 2;
-		if( ch < (uint32_t)0x10000)		return 3;
-		if( ch <= maxLegalUTF32 )		return 4;
-		return 0;
+		auto SkipSpace	= [&]()
+		{
+			while( psz<end && (*psz==' ' || *psz=='\n' || *psz=='\r' || *psz=='\t') )
+			{
+				++psz;
+			}
+		};
+		// psz is on the opening quote and is left after the closing quote
+		auto ReadString	= [&](char const** sz,size_t* szLen) -> bool
+		{
+			char const* begin	= ++psz;
+			bool escaped		= false;
+			while( psz<end && *psz!='\"' )
+			{
+				if( *psz == '\\' )
+				{
+					escaped	= true;
+					++psz;
+				}
+				++psz;
+			}
+			if( psz >= end )	return false;
+			*sz		= begin;
+			*szLen	= psz++ - begin;
+			if( escaped )
+			{
+				buffer.clear();
+				if( !UnescapeString(begin,*szLen,buffer) )	return false;
+				*sz		= buffer.c_str();
+				*szLen	= buffer.length();
+			}
+			return true;
+		};
+		auto ReadNumber	= [&]() -> bool
+		{
+			char const* begin	= psz;
+			bool integer		= true;
+			while( psz<end && ((*psz>='0' && *psz<='9') || *psz=='.' || *psz=='e' || *psz=='E' || *psz=='+' || *psz=='-') )
+			{
+				if( *psz=='.' || *psz=='e' || *psz=='E' )	integer = false;
+				++psz;
+			}
+			int64_t i;
+			uint64_t u;
+			if( integer && ParseInteger(begin,psz - begin,&i) )
+			{
+				return handler.OnInteger(i);
+			}
+			if( integer && ParseUnsigned(begin,psz - begin,&u) )
+			{
+				return handler.OnUnsigned(u);
+			}
+			double d;
+			if( !ParseDouble(begin,psz - begin,&d) )	return false;
+			return handler.OnNumber(d);
+		};
+
+		// Expecting a value, a key, or what follows a complete value
+		enum { StateValue, StateKey, StateNext } state	= StateValue;
+		for( ;; )
+		{
+			SkipSpace();
+			if( state == StateNext )
+			{
+				if( stack.empty() )
+				{
+					return psz == end || *psz == '\0';
+				}
+				if( psz >= end )	return false;
+				char const ch	= *psz++;
+				if( ch == ',' )
+				{
+					state	= stack.back()=='{' ? StateKey : StateValue;
+				}
+				else if( ch == '}' && stack.back()=='{' )
+				{
+					stack.pop_back();
+					if( !handler.OnEndObject() )	return false;
+				}
+				else if( ch == ']' && stack.back()=='[' )
+				{
+					stack.pop_back();
+					if( !handler.OnEndArray() )	return false;
+				}
+				else
+				{
+					return false;
+				}
+				continue;
+			}
+			if( psz >= end )	return false;
+
+			if( state == StateKey )
+			{
+				char const* sz;
+				size_t szLen;
+				if( *psz!='\"' || !ReadString(&sz,&szLen) )	return false;
+				if( !handler.OnKey(sz,szLen) )	return false;
+				SkipSpace();
+				if( psz>=end || *psz!=':' )	return false;
+				++psz;
+				state	= StateValue;
+				continue;
+			}
+
+			char const ch	= *psz;
+			state	= StateNext;
+			if( ch == '{' )
+			{
+				++psz;
+				if( !handler.OnStartObject() )	return false;
+				SkipSpace();
+				if( psz<end && *psz=='}' )
+				{
+					++psz;
+					if( !handler.OnEndObject() )	return false;
+					continue;
+				}
+				stack.push_back('{');
+				state	= StateKey;
+			}
+			else if( ch == '[' )
+			{
+				++psz;
+				if( !handler.OnStartArray() )	return false;
+				SkipSpace();
+				if( psz<end && *psz==']' )
+				{
+					++psz;
+					if( !handler.OnEndArray() )	return false;
+					continue;
+				}
+				stack.push_back('[');
+				state	= StateValue;
+			}
+			else if( ch == '\"' )
+			{
+				char const* sz;
+				size_t szLen;
+				if( !ReadString(&sz,&szLen) )	return false;
+				if( !handler.OnString(sz,szLen) )	return false;
+			}
+			else if( end-psz>=4 && strncmp(psz,"true",4)==0 )
+			{
+				psz	+= 4;
+				if( !handler.OnBoolean(true) )	return false;
+			}
+			else if( end-psz>=5 && strncmp(psz,"false",5)==0 )
+			{
+				psz	+= 5;
+				if( !handler.OnBoolean(false) )	return false;
+			}
+			else if( end-psz>=4 && strncmp(psz,"null",4)==0 )
+			{
+				psz	+= 4;
+				if( !handler.OnNull() )	return false;
+			}
+			else if( !ReadNumber() )
+			{
+				return false;
+			}
+		}
 	}
-	
+
 	//
-	// Convers a single unicode character and returns the number of bytes used to encode it
+	// Incremental event parsing - the document is passed to Feed in pieces as it arrives
+	// A token split across pieces is carried over, so memory use is the nesting depth plus the longest token
+	// With 'documents' a sequence of values is accepted (e.g. NDJSON) and OnEndDocument follows each one
 	//
-	inline int UTF8toUTF32Char(char const* utf8, uint32_t* utf32)
+	template<class Handler>
+	class EventStream
 	{
-		char const* src = utf8;
-		uint32_t c	= (uint32_t)(*src++);
-		if( (c & 0x80) != 0 )
+		public:
+		EventStream(Handler& handler,bool documents=false) : mHandler(handler),mDocuments(documents),mFailed(false),mOpened(false),mState(StateValue) {}
+
+		bool Feed(char const* data,size_t len)
 		{
-			if( (c & 0xe0) == 0xc0 )
+			if( mFailed )	return false;
+			char const* psz	= data;
+			char const* end	= data + len;
+
+			if( !mPending.empty() )
 			{
-				c	= (c & 0x1f) << 6;
-				if( (*src & 0xc0) != 0x80 ) return 0;
-				c	|= ((uint32_t)(*src++) & 0x3f);
+				size_t const n	= TokenEnd(psz,end);
+				if( n == SIZE_MAX )
+				{
+					mPending.append(psz,len);
+					return true;
+				}
+				mPending.append(psz,n);
+				psz	+= n;
+				if( !Token(mPending.data(),mPending.length()) )	return Fail();
+				mPending.clear();
 			}
-			else if( (c & 0xf0) == 0xe0 )
+
+			for( ;; )
 			{
-				c	= (c & 0xf) << 12;
-				if( (*src & 0xc0) != 0x80 ) return 0;
-				c	|= ((uint32_t)(*src++) & 0x3f) << 6;
-				if( (*src & 0xc0) != 0x80 ) return 0;
-				c	|= ((uint32_t)(*src++) & 0x3f);
+				while( psz<end && (*psz==' ' || *psz=='\n' || *psz=='\r' || *psz=='\t') )
+				{
+					++psz;
+				}
+				if( psz >= end )	return true;
+				char const ch	= *psz;
+
+				if( mState == StateNext )
+				{
+					if( mStack.empty() )
+					{
+						if( !mDocuments )	return Fail();
+						mState	= StateValue;
+						continue;
+					}
+					if( ch == ',' )
+					{
+						mState	= mStack.back()=='{' ? StateKey : StateValue;
+					}
+					else if( (ch == '}' && mStack.back()=='{') || (ch == ']' && mStack.back()=='[') )
+					{
+						if( !Close() )	return Fail();
+					}
+					else
+					{
+						return Fail();
+					}
+					++psz;
+					continue;
+				}
+				if( mState == StateColon )
+				{
+					if( ch != ':' )	return Fail();
+					mState	= StateValue;
+					++psz;
+					continue;
+				}
+
+				// Empty containers close where the first key or element would be
+				if( mOpened && ((ch == '}' && mState == StateKey) || (ch == ']' && mState == StateValue)) )
+				{
+					++psz;
+					if( !Close() )	return Fail();
+					continue;
+				}
+				mOpened	= false;
+				if( mState == StateKey && ch != '\"' )
+				{
+					return Fail();
+				}
+				if( ch == '{' || ch == '[' )
+				{
+					++psz;
+					mStack.push_back(ch);
+					mOpened	= true;
+					mState	= ch == '{' ? StateKey : StateValue;
+					if( !(ch == '{' ? mHandler.OnStartObject() : mHandler.OnStartArray()) )	return Fail();
+					continue;
+				}
+
+				mPending.assign(1,ch);
+				size_t const n	= TokenEnd(psz + 1,end);
+				if( n == SIZE_MAX )
+				{
+					mPending.assign(psz,end - psz);
+					return true;
+				}
+				mPending.clear();
+				if( !Token(psz,n + 1) )	return Fail();
+				psz	+= n + 1;
 			}
-			else if( (c & 0xf8) == 0xf0 )
+		}
+
+		// True when the input ended after a complete document, or between documents
+		bool Finish()
+		{
+			if( mFailed )	return false;
+			if( !mPending.empty() )
 			{
-				c	= (c & 0x7) << 18;
-				if( (*src & 0xc0) != 0x80 ) return 0;
-				c	|= ((uint32_t)(*src++) & 0x3f) << 12;
-				if( (*src & 0xc0) != 0x80 ) return 0;
-				c	|= ((uint32_t)(*src++) & 0x3f) << 6;
-				if( (*src & 0xc0) != 0x80 ) return 0;
-				c	|= ((uint32_t)(*src++) & 0x3f);
+				if( mPending[0] == '\"' || !Token(mPending.data(),mPending.length()) )	return Fail();
+				mPending.clear();
 			}
-			else
+			return mStack.empty() && (mState == StateNext || (mDocuments && mState == StateValue));
+		}
+
+		private:
+		bool Fail()
+		{
+			mFailed	= true;
+			return false;
+		}
+
+		// Bytes of [psz,end) that complete the token started in mPending, or SIZE_MAX if it continues
+		size_t TokenEnd(char const* psz,char const* end)
+		{
+			char const* p	= psz;
+			if( mPending[0] == '\"' )
 			{
-				return 0;
+				// A trailing backslash of the pending part escapes the first byte here
+				size_t slashes	= 0;
+				for( size_t i=mPending.length()-1; i>0 && mPending[i]=='\\'; --i )	++slashes;
+				if( slashes % 2 == 1 )	++p;
+				while( p<end && *p!='\"' )
+				{
+					p	+= *p=='\\' ? 2 : 1;
+				}
+				return p<end ? (size_t)(p - psz + 1) : SIZE_MAX;
+			}
+			while( p<end && ((*p>='0' && *p<='9') || (*p>='a' && *p<='z') || *p=='.' || *p=='+' || *p=='-' || *p=='E') )
+			{
+				++p;
 			}
+			return p<end ? (size_t)(p - psz) : SIZE_MAX;
 		}
-		*utf32	= c;
-		return (int)(src - utf8);
-	}
 
+		bool Value()
+		{
+			if( mStack.empty() )
+			{
+				mState	= StateNext;
+				return !mDocuments || mHandler.OnEndDocument();
+			}
+			mState	= StateNext;
+			return true;
+		}
+
+		bool Close()
+		{
+			char const open	= mStack.back();
+			mStack.pop_back();
+			mOpened	= false;
+			if( !(open == '{' ? mHandler.OnEndObject() : mHandler.OnEndArray()) )	return false;
+			return Value();
+		}
+
+		// A complete string, literal or number
+		bool Token(char const* sz,size_t len)
+		{
+			if( sz[0] == '\"' )
+			{
+				char const* str	= sz + 1;
+				size_t strLen	= len - 2;
+				if( memchr(str,'\\',strLen) != nullptr )
+				{
+					mBuffer.clear();
+					if( !UnescapeString(str,strLen,mBuffer) )	return false;
+					str		= mBuffer.c_str();
+					strLen	= mBuffer.length();
+				}
+				if( mState == StateKey )
+				{
+					mState	= StateColon;
+					return mHandler.OnKey(str,strLen);
+				}
+				return mHandler.OnString(str,strLen) && Value();
+			}
+			bool ok;
+			int64_t i;
+			uint64_t u;
+			double d;
+			if( len == 4 && memcmp(sz,"true",4) == 0 )			ok = mHandler.OnBoolean(true);
+			else if( len == 5 && memcmp(sz,"false",5) == 0 )	ok = mHandler.OnBoolean(false);
+			else if( len == 4 && memcmp(sz,"null",4) == 0 )		ok = mHandler.OnNull();
+			else if( ParseInteger(sz,len,&i) )					ok = mHandler.OnInteger(i);
+			else if( ParseUnsigned(sz,len,&u) )					ok = mHandler.OnUnsigned(u);
+			else if( ParseDouble(sz,len,&d) )					ok = mHandler.OnNumber(d);
+			else												return false;
+			return ok && Value();
+		}
+
+		enum State { StateValue, StateKey, StateColon, StateNext };
+
+		Handler&			mHandler;
+		bool				mDocuments;
+		bool				mFailed;
+		bool				mOpened;	// a container was just opened and may be empty
+		State				mState;
+		std::vector<char>	mStack;		// '{' or '[' for each open container
+		std::string			mPending;	// a token split across pieces
+		std::string			mBuffer;	// reused for strings with escapes
+	};
+
+
+#if defined(JSONIC_ZLIB) || defined(JSONIC_ZSTD)
 	//
+	// Compressed input - define JSONIC_ZLIB and/or JSONIC_ZSTD and link zlib/libzstd
+	// Decompression runs on its own thread and passes chunks to the parsing thread through a bounded queue,
+	// so the two overlap and only a few chunks of the uncompressed data are held at once
+	// gzip, zlib and zstd are detected from the leading bytes, concatenated members/frames are read in turn
 	//
+	class ChunkQueue
+	{
+		public:
+		ChunkQueue(size_t chunks,size_t chunkSize);
+
+		// Producer side - Acquire waits for a free chunk and returns nullptr once the consumer has cancelled
+		std::string* Acquire();
+		void Push(std::string* chunk);
+		void Close(bool ok);
+
+		// Consumer side - Pop waits for a chunk and returns nullptr after the last one
+		std::string* Pop();
+		void Release(std::string* chunk);
+		void Cancel();
+		bool Succeeded();
+
+		size_t ChunkSize() const	{ return mChunkSize; }
+
+		private:
+		std::mutex					mMutex;
+		std::condition_variable		mChanged;
+		std::vector<std::string>	mStorage;
+		std::vector<std::string*>	mFree;
+		std::deque<std::string*>	mFull;
+		size_t						mChunkSize;
+		bool						mClosed;
+		bool						mCancelled;
+		bool						mSucceeded;
+	};
+
+	// Runs on the producer thread, fills the queue and closes it
+	void Decompress(char const* src,size_t len,ChunkQueue& queue);
+
 	//
-	inline size_t UTF8toUTF32String(char const* utf8, uint32_t* utf32, size_t* errorPos = nullptr)
+	// Calls consume(data,len) for each decompressed chunk in order, consume returns false to stop
+	//
+	template<class Consumer>
+	bool ReadCompressed(char const* src,size_t len,Consumer consume)
 	{
-		if( !utf8 || !utf32 )
+		ChunkQueue queue(4,1 << 16);
+		std::thread producer;
+		try
 		{
-			if( errorPos ) *errorPos = 0;
-			return 0;
+			producer	= std::thread([&]() { Decompress(src,len,queue); });
 		}
-		char const* src = utf8;
-		uint32_t* dst	= utf32;
-		size_t error	= 0;
-
-		while( *src != 0 )
+		catch( std::system_error const& )
 		{
-			int n = UTF8toUTF32Char(src, dst);
-			if( n == 0 )
+			return false;
+		}
+		bool ok	= true;
+		try
+		{
+			while( std::string* chunk = queue.Pop() )
 			{
-				if( errorPos )
+				ok	= consume(chunk->data(),chunk->length());
+				queue.Release(chunk);
+				if( !ok )
 				{
-					*errorPos = src - utf8;
+					queue.Cancel();
+					break;
 				}
-				return 0;
 			}
-			src += n;
-			++dst;
 		}
-		*dst = 0;
-		return dst - utf32;
+		catch( ... )
+		{
+			// The producer may be waiting for a chunk, and a joinable thread must not be destroyed
+			queue.Cancel();
+			producer.join();
+			throw;
+		}
+		producer.join();
+		return ok && queue.Succeeded();
 	}
 
 	//
-	// utf8 must have a maximum of 4 bytes available
+	// Event parsing of a compressed document, or of a sequence of documents such as NDJSON with 'documents'
 	//
-	inline int UTF32toUTF8Char(uint32_t utf32, char* utf8)
+	template<class Handler>
+	bool ParseCompressed(char const* src,size_t len,Handler& handler,bool documents=false)
 	{
-		static const uint8_t firstByteMark[7] = { 0x00, 0x00, 0xC0, 0xE0, 0xF0, 0xF8, 0xFC };
-		static const uint8_t byteMask = 0xBF;
-		static const uint8_t byteMark = 0x80; 
+		EventStream<Handler> stream(handler,documents);
+		return ReadCompressed(src,len,[&](char const* data,size_t n) { return stream.Feed(data,n); }) && stream.Finish();
+	}
 
-		int const n	= UTF32toUTF8Length(utf32);
-		utf8	+= n;
-		switch( n )
+	//
+	// Parses every line of compressed NDJSON into a Member tree and calls onDocument(root), which returns false to stop
+	// The tree points into a line buffer that is reused for the next line
+	//
+	template<class Callback>
+	bool ParseCompressedLines(char const* src,size_t len,Callback onDocument,int flags=0)
+	{
+		std::string line;
+		auto Emit	= [&]() -> bool
 		{
-			// All cases fall through
-			case 4: *--utf8 = (char)((utf32 | byteMark) & byteMask); utf32 >>= 6;
-			case 3: *--utf8 = (char)((utf32 | byteMark) & byteMask); utf32 >>= 6;
-			case 2: *--utf8 = (char)((utf32 | byteMark) & byteMask); utf32 >>= 6;
-			case 1: *--utf8 = (char) (utf32 | firstByteMark[n]);
-		}
-		return n;
+			if( line.find_first_not_of(" \t\r\n") != std::string::npos )
+			{
+				Member root(line.c_str(),line.length());
+				if( !Parse(root,flags) || !onDocument(root) )	return false;
+			}
+			line.clear();
+			return true;
+		};
+		return ReadCompressed(src,len,[&](char const* data,size_t n) -> bool
+		{
+			char const* end	= data + n;
+			while( char const* newline = (char const*)memchr(data,'\n',end - data) )
+			{
+				line.append(data,newline - data);
+				if( !Emit() )	return false;
+				data	= newline + 1;
+			}
+			line.append(data,end - data);
+			return true;
+		}) && Emit();
 	}
+#endif
 
 
-	inline bool IsWhiteSpace(uint32_t code)
+	//
+	// JSON Schema validation of a practical subset of the keywords:
+	// type, properties, required, enum (of scalars), minimum, maximum, exclusiveMinimum, exclusiveMaximum,
+	// minLength, maxLength and items (a single schema) - other keywords are ignored
+	// A schema is compiled once into a table of rules and can be shared by any number of validators
+	//
+	class Schema
 	{
-		switch(code)
+		public:
+		enum Type
 		{
-			case 0x0009:
-			case 0x000A:
-			case 0x000B:
-			case 0x000C:
-			case 0x000D:
-			case 0x0020:
-			case 0x0085:
-			case 0x00A0:
-			case 0x1680:
-			case 0x2000:
-			case 0x2001:
+			TypeNull	= 1 << 0,
+			TypeBoolean	= 1 << 1,
+			TypeInteger	= 1 << 2,
+			TypeNumber	= 1 << 3,
+			TypeString	= 1 << 4,
+			TypeArray	= 1 << 5,
+			TypeObject	= 1 << 6,
+			TypeAny		= 0x7f
+		};
+		static const uint32_t None	= UINT32_MAX;	// rule of values without constraints
+
+		struct Property
+		{
+			std::string	name;
+			uint32_t	rule;
+			bool		required;
+		};
+		// Integers that fit in 64 bits are held exactly, so values above 2^53 still compare correctly
+		struct Number
+		{
+			double		value;
+			bool		integral;	// 'negative' and 'magnitude' hold the value exactly
+			bool		negative;
+			uint64_t	magnitude;
+		};
+		struct Constant
+		{
+			uint32_t	type;	// one Type bit, numbers are TypeNumber
+			Number		number;
+			bool		boolean;
+			std::string	string;
+		};
+		struct Rule
+		{
+			uint32_t				types;			// Type bits a value may have, TypeNumber includes integers
+			Number					minimum;		// -infinity when absent
+			Number					maximum;		// infinity when absent
+			bool					minimumExclusive;
+			bool					maximumExclusive;
+			size_t					minLength;		// in code points
+			size_t					maxLength;		// SIZE_MAX when absent
+			uint32_t				items;
+			std::vector<Property>	properties;		// sorted by name, including required names without a schema
+			std::vector<Constant>	enumeration;	// empty when not restricted
+		};
+
+		// Fails on invalid JSON or an unsupported use of a keyword, e.g. enum listing objects
+		bool Compile(char const* json,size_t len,std::string* error=nullptr);
+		bool Compiled() const	{ return !mRules.empty(); }
+
+		Rule const& GetRule(uint32_t rule) const	{ return mRules[rule]; }
+
+		private:
+		uint32_t CompileRule(Member const& m,std::string& error);
+
+		std::vector<Rule>	mRules;	// the first rule is the root
+	};
+
+	//
+	// Validates the events of one document after another against a Schema, stopping at the first violation
+	// Use it as the handler of ParseEvents, EventStream or ParseCompressed, or with Parse(root,validator)
+	// to validate while the Member tree is built
+	//
+	class SchemaValidator : public EventHandler<SchemaValidator>
+	{
+		public:
+		explicit SchemaValidator(Schema const& schema) : mSchema(schema),mDepth(0) {}
+
+		void Reset();
+
+		// The first violation and the JSON Pointer of the value, e.g. "/items/2/price: above maximum"
+		std::string const& Error() const	{ return mError; }
+
+		bool OnNull();
+		bool OnBoolean(bool value);
+		bool OnNumber(double value);
+		bool OnInteger(int64_t value);
+		bool OnUnsigned(uint64_t value);
+		bool OnString(char const* sz,size_t len);
+		bool OnKey(char const* sz,size_t len);
+		bool OnStartObject();
+		bool OnEndObject();
+		bool OnStartArray();
+		bool OnEndArray();
+
+		private:
+		struct Frame
+		{
+			uint32_t	rule;
+			uint32_t	next;	// rule of the value after the current key, or of every element
+			bool		object;
+			size_t		index;	// elements so far
+			size_t		seen;	// offset of the required property bits in mSeen
+			std::string	key;
+		};
+
+		uint32_t Begin();
+		bool Check(uint32_t rule,uint32_t type);
+		bool CheckConstant(uint32_t rule,Schema::Constant const& value);
+		bool CheckNumber(Schema::Number const& value);
+		bool Fail(std::string const& message);
+
+		Schema const&			mSchema;
+		std::vector<Frame>		mStack;	// frames are reused, only the first mDepth are open
+		size_t					mDepth;
+		std::vector<uint64_t>	mSeen;
+		std::string				mError;
+	};
+
+	// Validates while building the tree, a document that breaks the schema fails as soon as that is known
+	bool Parse(Member& root,SchemaValidator& validator,int flags=ParseDefault);
+
+
+	//
+	// Read only view of a whole file, memory mapped where the platform allows it and read otherwise
+	//
+	class MappedFile
+	{
+		public:
+		MappedFile() : mData(nullptr),mSize(0),mMapped(false) {}
+		~MappedFile()	{ Close(); }
+
+		bool Open(char const* path);
+		void Close();
+
+		char const* Data() const	{ return mData; }
+		size_t Size() const			{ return mSize; }
+
+		private:
+		MappedFile(MappedFile const&);
+		MappedFile& operator=(MappedFile const&);
+
+		char const*			mData;
+		size_t				mSize;
+		bool				mMapped;
+		std::vector<char>	mBuffer;	// contents when the file could not be mapped
+	};
+
+	//
+	// Sparse index of the structure of a large JSON document, built once and saved next to it
+	// Every value down to 'depth' levels below the root is recorded with its byte span, and the members
+	// of indexed objects are sorted by key, so a lookup goes straight to a span and parses only that
+	// The saved index is mapped by Open, so loading it costs the same for any document size
+	//
+	class StructuralIndex
+	{
+		public:
+		static const uint32_t None	= UINT32_MAX;
+
+		// Stored in the file as they are, so an index is read on machines with the same byte order
+		struct Entry
+		{
+			uint64_t	offset;	// span of the value in the source
+			uint64_t	length;
+			uint32_t	type;	// MemberType, VALUE for scalars
+			uint32_t	count;	// indexed members or elements, 0 below the indexed depth
+			uint64_t	first;	// first of them in the child table
+		};
+		struct Child
+		{
+			uint32_t	entry;
+			uint32_t	keyLength;	// unescaped key, 0 for array elements
+			uint64_t	keyOffset;
+		};
+
+		StructuralIndex() : mEntries(nullptr),mChildren(nullptr),mKeys(nullptr) { memset(&mHeader,0,sizeof(mHeader)); }
+
+		// Only the structure is checked, values below the indexed depth are skipped without validation
+		bool Build(char const* src,size_t len,uint32_t depth=1);
+		bool Save(char const* path) const;
+		bool Open(char const* path);
+
+		// Compares the length and checksum of 'src' with the indexed source, which reads all of it
+		bool Matches(char const* src,size_t len) const;
+		uint64_t SourceLength() const	{ return mHeader.sourceLength; }
+
+		uint32_t Root() const	{ return mHeader.entries > 0 ? 0 : None; }
+		size_t Size() const		{ return (size_t)mHeader.entries; }
+		Entry const* GetEntry(uint32_t entry) const;
+
+		// Indexed member 'sz' of an object, or element 'index' of an array, None when absent or not indexed
+		uint32_t Find(uint32_t entry,char const* sz,size_t len=0) const;
+		uint32_t At(uint32_t entry,size_t index) const;
+
+		// Copies the span of 'entry' from 'src' into 'buffer' and parses it into 'out', which refers to 'buffer'
+		bool Parse(uint32_t entry,char const* src,size_t len,Member& out,std::string& buffer,int flags=ParseDefault) const;
+
+		private:
+		struct Header
+		{
+			char		magic[8];
+			uint32_t	version;
+			uint32_t	depth;
+			uint64_t	sourceLength;
+			uint64_t	checksum;
+			uint64_t	entries;
+			uint64_t	children;
+			uint64_t	keyBytes;
+		};
+		StructuralIndex(StructuralIndex const&);
+		StructuralIndex& operator=(StructuralIndex const&);
+
+		Header				mHeader;
+		Entry const*		mEntries;	// into the vectors below after Build, or into mFile after Open
+		Child const*		mChildren;
+		char const*			mKeys;
+		std::vector<Entry>	mBuiltEntries;
+		std::vector<Child>	mBuiltChildren;
+		std::string			mBuiltKeys;
+		MappedFile			mFile;
+	};
+
+
+	//
+	// Converts between JSON text and a binary format directly, without building a Member tree
+	// The result is appended to 'out', which is left unchanged on failure
+	//
+	bool Transcode(char const* src,size_t len,Format from,Format to,std::string& out);
+
+	//
+	// Reformat JSON text without building a tree, copying strings and numbers through unchanged
+	// The input is not validated beyond unterminated strings and, for Prettify, unbalanced brackets
+	// The result is appended to 'out', which is left unchanged on failure
+	//
+	bool Minify(char const* src,size_t len,std::string& out);
+	bool Prettify(char const* src,size_t len,std::string& out,int indent=4);
+	// Minifies the first *len bytes of 'src' in place and sets *len to the new length
+	// On failure *len is unchanged and the buffer may be partly minified
+	bool Minify(char* src,size_t* len);
+
+
+	//
+	//
+	//
+	class BuildNode
+	{
+		public:
+		static void PrintNode(BuildNode const& node, std::string& json);
+		// Binary output writes a value that is not valid JSON text as null, so container counts stay correct
+		static void PrintNode(BuildNode const& node, std::string& out, Format format);
+
+		BuildNode() : type(MemberType::OBJECT) {}
+		BuildNode(std::string const& key, BuildNode const& value)
+		{
+			type	= MemberType::KEY;
+			mKey	= key;
+			nodes.push_back(value);
+		}
+		BuildNode(std::string const& value) : type(MemberType::VALUE)
+		{
+			values.push_back(ParseValue(value));
+		}
+		BuildNode(int value) : type(MemberType::VALUE)
+		{
+			values.push_back(std::to_string(value));
+		}
+		BuildNode(double value) : type(MemberType::VALUE)
+		{
+			values.push_back(std::to_string(value));
+		}
+		BuildNode(bool value) : type(MemberType::VALUE)
+		{
+			values.push_back(value ? "true" : "false");
+		}
+		BuildNode(nullptr_t) : type(MemberType::VALUE)
+		{
+			values.push_back("null");
+		}
+		BuildNode(std::vector<BuildNode> const& list) : type(MemberType::ARRAY)
+		{
+			nodes = list;
+		}
+		BuildNode(std::vector<std::string> const& list) : type(MemberType::ARRAY)
+		{
+			for( std::string const& v : list )
+			{
+				values.push_back(ParseValue(v));
+			}
+		}
+		BuildNode(std::vector<int> const& list) : type(MemberType::ARRAY)
+		{
+			for( int v : list )
+			{
+				values.push_back(std::to_string(v));
+			}
+		}
+		BuildNode(std::vector<double> const& list) : type(MemberType::ARRAY)
+		{
+			for( double v : list )
+			{
+				values.push_back(std::to_string(v));
+			}
+		}
+		BuildNode(std::initializer_list<BuildNode> const& list) : type(MemberType::ARRAY)
+		{
+			nodes = list;
+		}
+		BuildNode(std::initializer_list<char const*> const& list) : type(MemberType::ARRAY)
+		{
+			for( char const* v : list )
+			{
+				values.push_back(ParseValue(v));
+			}
+		}
+		BuildNode(std::initializer_list<std::string> const& list) : type(MemberType::ARRAY)
+		{
+			for( std::string const& v : list )
+			{
+				values.push_back(ParseValue(v));
+			}
+		}
+		BuildNode(std::initializer_list<int> const& list) : type(MemberType::ARRAY)
+		{
+			for( int v : list )
+			{
+				values.push_back(std::to_string(v));
+			}
+		}
+		BuildNode(std::initializer_list<double> const& list) : type(MemberType::ARRAY)
+		{
+			for( double v : list )
+			{
+				values.push_back(std::to_string(v));
+			}
+		}
+
+		void AddNode(std::string const& key, BuildNode const& value)
+		{
+			nodes.push_back(BuildNode(key, value));
+		}
+
+		private:
+		std::string ParseValue(std::string const& str) const
+		{
+			std::string result;
+			result	+= '\"';
+			for( char ch : str )
+			{
+				if( ch == '\\' )		{ result += "\\\\"; }
+				else if( ch == '/' )	{ result += "\\/"; }
+				else if( ch == '\"' )	{ result += "\\\""; }
+				else if( ch == '\b' )	{ result += "\\b"; }
+				else if( ch == '\f' )	{ result += "\\f"; }
+				else if( ch == '\n' )	{ result += "\\n"; }
+				else if( ch == '\r' )	{ result += "\\r"; }
+				else if( ch == '\t' )	{ result += "\\t"; }
+				else					{ result += ch;	}
+			}
+			result += '\"';
+			return result;
+		}
+		MemberType					type;
+		std::string					mKey;
+		std::vector<std::string>	values;
+		std::vector<BuildNode>		nodes;
+	};
+
+};
+
+
+#ifdef JSONIC_IMPLEMENTATION
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+// Only ExtractColumns starts threads here, the source that defines JSONIC_IMPLEMENTATION links the thread library
+#include <thread>
+// Only MappedFile needs these, so they stay out of the headers of consumers
+#if defined(__unix__) || defined(__APPLE__)
+#define JSONIC_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace jsonic
+{
+	// String utility functions would be useful in their own header, however, in keeping with a single header library...
+
+	//
+	// Returns the number of bytes required to encode the character
+	//
+	inline int UTF8CharLength(char ch)
+	{
+		uint8_t const c	= (uint8_t)ch;
+		if( c <= 127 )				return 1;
+		if( (c & 0xe0) == 0xc0 )	return 2;
+		if( (c & 0xf0) == 0xe0 )	return 3;
+		if( (c & 0xf8) == 0xf0 )	return 4;
+		return 1;
+	}
+	inline int UTF32toUTF8Length(uint32_t ch)
+	{
+		constexpr uint32_t maxLegalUTF32 = 0x0010FFFF;
+		if( ch < (uint32_t)0x80 )		return 1;
+		if( ch < (uint32_t)0x800 )		return 2;
+		if( ch < (uint32_t)0x10000)		return 3;
+		if( ch <= maxLegalUTF32 )		return 4;
+		return 0;
+	}
+
+	//
+	// Convers a single unicode character and returns the number of bytes used to encode it
+	//
+	inline int UTF8toUTF32Char(char const* utf8, uint32_t* utf32)
+	{
+		char const* src = utf8;
+		uint32_t c	= (uint32_t)(*src++);
+		if( (c & 0x80) != 0 )
+		{
+			if( (c & 0xe0) == 0xc0 )
+			{
+				c	= (c & 0x1f) << 6;
+				if( (*src & 0xc0) != 0x80 ) return 0;
+				c	|= ((uint32_t)(*src++) & 0x3f);
+			}
+			else if( (c & 0xf0) == 0xe0 )
+			{
+				c	= (c & 0xf) << 12;
+				if( (*src & 0xc0) != 0x80 ) return 0;
+				c	|= ((uint32_t)(*src++) & 0x3f) << 6;
+				if( (*src & 0xc0) != 0x80 ) return 0;
+				c	|= ((uint32_t)(*src++) & 0x3f);
+			}
+			else if( (c & 0xf8) == 0xf0 )
+			{
+				c	= (c & 0x7) << 18;
+				if( (*src & 0xc0) != 0x80 ) return 0;
+				c	|= ((uint32_t)(*src++) & 0x3f) << 12;
+				if( (*src & 0xc0) != 0x80 ) return 0;
+				c	|= ((uint32_t)(*src++) & 0x3f) << 6;
+				if( (*src & 0xc0) != 0x80 ) return 0;
+				c	|= ((uint32_t)(*src++) & 0x3f);
+			}
+			else
+			{
+				return 0;
+			}
+		}
+		*utf32	= c;
+		return (int)(src - utf8);
+	}
+
+	//
+	//
+	//
+	inline size_t UTF8toUTF32String(char const* utf8, uint32_t* utf32, size_t* errorPos = nullptr)
+	{
+		if( !utf8 || !utf32 )
+		{
+			if( errorPos ) *errorPos = 0;
+			return 0;
+		}
+		char const* src = utf8;
+		uint32_t* dst	= utf32;
+		size_t error	= 0;
+
+		while( *src != 0 )
+		{
+			int n = UTF8toUTF32Char(src, dst);
+			if( n == 0 )
+			{
+				if( errorPos )
+				{
+					*errorPos = src - utf8;
+				}
+				return 0;
+			}
+			src += n;
+			++dst;
+		}
+		*dst = 0;
+		return dst - utf32;
+	}
+
+	//
+	// utf8 must have a maximum of 4 bytes available
+	//
+	inline int UTF32toUTF8Char(uint32_t utf32, char* utf8)
+	{
+		static const uint8_t firstByteMark[7] = { 0x00, 0x00, 0xC0, 0xE0, 0xF0, 0xF8, 0xFC };
+		static const uint8_t byteMask = 0xBF;
+		static const uint8_t byteMark = 0x80;
+
+		int const n	= UTF32toUTF8Length(utf32);
+		utf8	+= n;
+		switch( n )
+		{
+			// All cases fall through
+			case 4: *--utf8 = (char)((utf32 | byteMark) & byteMask); utf32 >>= 6;
+			case 3: *--utf8 = (char)((utf32 | byteMark) & byteMask); utf32 >>= 6;
+			case 2: *--utf8 = (char)((utf32 | byteMark) & byteMask); utf32 >>= 6;
+			case 1: *--utf8 = (char) (utf32 | firstByteMark[n]);
+		}
+		return n;
+	}
+
+
+	inline bool IsWhiteSpace(uint32_t code)
+	{
+		switch(code)
+		{
+			case 0x0009:
+			case 0x000A:
+			case 0x000B:
+			case 0x000C:
+			case 0x000D:
+			case 0x0020:
+			case 0x0085:
+			case 0x00A0:
+			case 0x1680:
+			case 0x2000:
+			case 0x2001:
 			case 0x2002:
 			case 0x2003:
 			case 0x2004:
@@ -480,421 +1929,3984 @@ namespace jsonic
 			case 0xFEFF:
 				return true;
 		};
-		return false;
-	}
-	inline bool IsBreakSpace(uint32_t code)
-	{
-		switch(code)
+		return false;
+	}
+	inline bool IsBreakSpace(uint32_t code)
+	{
+		switch(code)
+		{
+			case 0x0009:
+			case 0x000A:
+			case 0x000B:
+			case 0x000C:
+			case 0x000D:
+			case 0x0020:
+			case 0x0085:
+			//case 0x00A0:
+			case 0x1680:
+			case 0x2000:
+			case 0x2001:
+			case 0x2002:
+			case 0x2003:
+			case 0x2004:
+			case 0x2005:
+			case 0x2006:
+			//case 0x2007:
+			case 0x2008:
+			case 0x2009:
+			case 0x200A:
+			case 0x2028:
+			case 0x2029:
+			//case 0x202F:
+			case 0x205F:
+			//case 0x2060:
+			case 0x3000:
+			//case 0xFEFF:
+				return true;
+		};
+		return false;
+	}
+	inline bool IsLineBreak(uint32_t code)
+	{
+		return code == 0x0A || code == 0x85;
+	}
+
+
+	inline bool IsWhiteSpace(char ch)
+	{
+		return IsWhiteSpace((uint32_t)ch);
+	}
+	inline bool IsWhiteSpace(wchar_t ch)
+	{
+		return IsWhiteSpace((uint32_t)ch);
+	}
+	inline bool IsWhiteSpace(char const* str)
+	{
+		uint32_t code;
+		UTF8toUTF32Char(str, &code);
+		return IsWhiteSpace(code);
+	}
+
+	template<class T>
+	inline int TStringCmp(T const* szA,T const* szB)
+	{
+		while(*szA != 0)
+		{
+			if(*szB == 0)	return  1;
+			if(*szB > *szA)	return -1;
+			if(*szA > *szB)	return  1;
+
+			szA++;
+			szB++;
+		}
+
+		if(*szB != 0)	return -1;
+		return 0;
+	}
+
+
+
+	//
+	//
+	//
+	inline bool IsAscii(char ch)
+	{
+		return ((uint8_t)ch & 0x80) == 0;
+	}
+	inline bool IsUTF8(char ch)
+	{
+		return ((uint8_t)ch & 0xc0) != 0x80;
+	}
+	inline bool IsTrailingUTF8(char ch)
+	{
+		return ((uint8_t)ch & 0x80) != 0;
+	}
+
+
+
+	//
+	//
+	//
+	inline size_t TrimLeft(char const* str,size_t len)
+	{
+		size_t i	= 0;
+		while( i<len && IsWhiteSpace(&str[i]) )
+		{
+			i	+= UTF8CharLength(str[i]);
+		}
+		return i;
+	}
+	inline size_t TrimRight(char const* str,size_t len)
+	{
+		if( len==0 )	return 0;
+		size_t k	= len-1;
+		while( k>0 && (IsTrailingUTF8(str[k]) || IsWhiteSpace(&str[k])) )
+		{
+			--k;
+		}
+		return len-1 - k;
+	}
+	inline bool Trim(char const* str,size_t len,size_t* nFront,size_t* nBack)
+	{
+		*nFront	= TrimLeft(str,len);
+		*nBack	= 0;
+		if( *nFront < len )
+		{
+			*nBack	= TrimRight(str + *nFront,len - *nFront);
+		}
+		return *nFront > 0 || *nBack > 0;
+	}
+	inline bool Trim(char const* str,size_t len)
+	{
+		size_t nFront,nBack;
+		return Trim(str,len,&nFront,&nBack);
+	}
+	inline void Trim(std::string& str)
+	{
+		size_t n,m;
+		size_t len	= str.length();
+		if( Trim(str.c_str(),len,&n,&m) )
+		{
+			str.erase(len - m,m);
+			str.erase(0,n);
+		}
+	}
+
+	//
+	// Helper function to parse the inside of JSON quotes
+	// Checks for escape characters
+	//
+	Value ParseString(char const* sz,size_t len)
+	{
+		char hex[8]		= {0};
+		char const Esc	= '\\';
+
+		Value v(sz,len,len*3/2);
+		char* out	= v.str;
+
+		for( size_t i=0; i<len; ++i )
+		{
+			char ci	= sz[i];
+			if( ci == Esc )
+			{
+				if( i+1 >= len )	return Value(ValueError);
+				ci	= sz[++i];
+
+				// Quote("), Backslash(\), and Forward-slash(/) are already set once the escape character is removed
+				if( ci=='b' )		ci	= '\b';
+				else if( ci=='f' )	ci	= '\f';
+				else if( ci=='n' )	ci	= '\n';
+				else if( ci=='r' )	ci	= '\r';
+				else if( ci=='t' )	ci	= '\t';
+				else if( ci=='u' )
+				{
+					if( i+4 >= len )	return Value(ValueError);
+					hex[0]	= sz[++i];	hex[1]	= sz[++i];	hex[2]	= sz[++i];	hex[3]	= sz[++i];
+					uint32_t code	= (uint32_t)strtol(hex,nullptr,16);
+					int num = UTF32toUTF8Char(code, hex);
+					for( int k=0; k<num-1; ++k )
+					{
+						*out++	= hex[k];
+					}
+					ci	= hex[num-1];
+				}
+			}
+			*out++	= ci;
+		}
+		v.len	= out - v.str;
+		v.str[v.len] = '\0';
+		return v;
+	}
+
+	//
+	// Binary encodings
+	// MessagePack and CBOR items are read in place, the same as JSON text. A Member spans the
+	// encoded bytes of its item and GetValue decodes them when requested
+	//
+	static const int BinaryMaxDepth	= 1024;
+
+	enum BinaryKind
+	{
+		BinaryNull=0,
+		BinaryBoolean,
+		BinaryInt,
+		BinaryUInt,
+		BinaryDouble,
+		BinaryString,	// text or byte string
+		BinaryArray,
+		BinaryMap,
+		BinaryBreak,	// end of an indefinite length CBOR item
+		BinaryError
+	};
+
+	struct BinaryHeader
+	{
+		BinaryKind	kind;
+		size_t		size;		// bytes used by the header (including any CBOR tags)
+		uint64_t	count;		// string bytes, array items or map pairs
+		bool		indefinite;	// CBOR only, items follow until a break
+		union
+		{
+			int64_t		i;
+			uint64_t	u;
+			double		d;
+			bool		boolean;
+		};
+	};
+
+	inline uint64_t ReadBigEndian(char const* p,int n)
+	{
+		uint64_t v	= 0;
+		for( int i=0; i<n; ++i )
+		{
+			v	= (v << 8) | (uint8_t)p[i];
+		}
+		return v;
+	}
+	inline void WriteBigEndian(std::string& out,uint64_t v,int n)
+	{
+		for( int i=n-1; i>=0; --i )
+		{
+			out	+= (char)((v >> (i*8)) & 0xff);
+		}
+	}
+	inline double BitsToDouble(uint64_t bits)
+	{
+		double d;
+		memcpy(&d,&bits,sizeof(d));
+		return d;
+	}
+	inline double FloatBitsToDouble(uint32_t bits)
+	{
+		float f;
+		memcpy(&f,&bits,sizeof(f));
+		return f;
+	}
+	inline double HalfBitsToDouble(uint32_t half)
+	{
+		int const exp		= (half >> 10) & 0x1f;
+		int const mant		= half & 0x3ff;
+		double const sign	= (half & 0x8000) ? -1.0 : 1.0;
+		if( exp == 0 )	return sign * ldexp(mant, -24);
+		if( exp == 31 )	return mant == 0 ? sign * HUGE_VAL : NAN;
+		return sign * ldexp(mant + 1024, exp - 25);
+	}
+
+	//
+	// Decodes the header of the item at 'p'
+	// For scalars the header is the whole item, strings and containers are followed by their content
+	//
+	inline bool ReadBinaryHeader(char const* p,size_t len,Format format,BinaryHeader& h)
+	{
+		h.kind			= BinaryError;
+		h.size			= 0;
+		h.count			= 0;
+		h.indefinite	= false;
+		h.u				= 0;
+		if( len == 0 )	return false;
+
+		uint8_t const b	= (uint8_t)p[0];
+		if( format == FormatMsgPack )
+		{
+			// Number of big endian bytes following the type byte
+			auto Fixed	= [&](BinaryKind kind,int n) -> bool
+			{
+				if( len < (size_t)n + 1 )	return false;
+				h.kind	= kind;
+				h.size	= n + 1;
+				h.u		= ReadBigEndian(p + 1,n);
+				return true;
+			};
+			auto Counted	= [&](BinaryKind kind,int n) -> bool
+			{
+				if( !Fixed(kind,n) )	return false;
+				h.count	= h.u;
+				return true;
+			};
+
+			if( b <= 0x7f )	{ h.kind = BinaryUInt; h.size = 1; h.u = b; return true; }
+			if( b >= 0xe0 )	{ h.kind = BinaryInt; h.size = 1; h.i = (int8_t)b; return true; }
+			if( b <= 0x8f )	{ h.kind = BinaryMap; h.size = 1; h.count = b & 0x0f; return true; }
+			if( b <= 0x9f )	{ h.kind = BinaryArray; h.size = 1; h.count = b & 0x0f; return true; }
+			if( b <= 0xbf )	{ h.kind = BinaryString; h.size = 1; h.count = b & 0x1f; return true; }
+			switch( b )
+			{
+				case 0xc0:	h.kind = BinaryNull; h.size = 1; return true;
+				case 0xc2:	h.kind = BinaryBoolean; h.size = 1; h.boolean = false; return true;
+				case 0xc3:	h.kind = BinaryBoolean; h.size = 1; h.boolean = true; return true;
+				case 0xc4:	return Counted(BinaryString,1);
+				case 0xc5:	return Counted(BinaryString,2);
+				case 0xc6:	return Counted(BinaryString,4);
+				case 0xca:	if( !Fixed(BinaryDouble,4) ) return false; h.d = FloatBitsToDouble((uint32_t)h.u); return true;
+				case 0xcb:	if( !Fixed(BinaryDouble,8) ) return false; h.d = BitsToDouble(h.u); return true;
+				case 0xcc:	return Fixed(BinaryUInt,1);
+				case 0xcd:	return Fixed(BinaryUInt,2);
+				case 0xce:	return Fixed(BinaryUInt,4);
+				case 0xcf:	return Fixed(BinaryUInt,8);
+				case 0xd0:	if( !Fixed(BinaryInt,1) ) return false; h.i = (int8_t)h.u; return true;
+				case 0xd1:	if( !Fixed(BinaryInt,2) ) return false; h.i = (int16_t)h.u; return true;
+				case 0xd2:	if( !Fixed(BinaryInt,4) ) return false; h.i = (int32_t)h.u; return true;
+				case 0xd3:	return Fixed(BinaryInt,8);
+				case 0xd9:	return Counted(BinaryString,1);
+				case 0xda:	return Counted(BinaryString,2);
+				case 0xdb:	return Counted(BinaryString,4);
+				case 0xdc:	return Counted(BinaryArray,2);
+				case 0xdd:	return Counted(BinaryArray,4);
+				case 0xde:	return Counted(BinaryMap,2);
+				case 0xdf:	return Counted(BinaryMap,4);
+			}
+			// Extension types have no JSON equivalent
+			return false;
+		}
+		else if( format == FormatCBOR )
+		{
+			size_t pos	= 0;
+			while( pos < len )
+			{
+				uint8_t const c		= (uint8_t)p[pos];
+				int const major		= c >> 5;
+				int const info		= c & 0x1f;
+				uint64_t arg		= info;
+				int n				= 0;
+				++pos;
+
+				if( info == 24 )		n	= 1;
+				else if( info == 25 )	n	= 2;
+				else if( info == 26 )	n	= 4;
+				else if( info == 27 )	n	= 8;
+				else if( info >= 28 && info != 31 )	return false;
+				if( len - pos < (size_t)n )	return false;
+				if( n > 0 )
+				{
+					arg	= ReadBigEndian(p + pos,n);
+					pos	+= n;
+				}
+				h.size	= pos;
+
+				if( info == 31 && (major < 2 || major == 6) )	return false;
+				switch( major )
+				{
+					case 0:	h.kind = BinaryUInt; h.u = arg; return true;
+					case 1:	h.kind = BinaryInt; h.i = -1 - (int64_t)arg; return true;
+					case 2:
+					case 3:	h.kind = BinaryString; h.count = arg; h.indefinite = info == 31; return true;
+					case 4:	h.kind = BinaryArray; h.count = arg; h.indefinite = info == 31; return true;
+					case 5:	h.kind = BinaryMap; h.count = arg; h.indefinite = info == 31; return true;
+					case 6:	continue;	// Tags are skipped, the tagged item follows
+					case 7:
+						if( info == 20 || info == 21 )	{ h.kind = BinaryBoolean; h.boolean = info == 21; return true; }
+						if( info == 22 || info == 23 )	{ h.kind = BinaryNull; return true; }
+						if( info == 25 )				{ h.kind = BinaryDouble; h.d = HalfBitsToDouble((uint32_t)arg); return true; }
+						if( info == 26 )				{ h.kind = BinaryDouble; h.d = FloatBitsToDouble((uint32_t)arg); return true; }
+						if( info == 27 )				{ h.kind = BinaryDouble; h.d = BitsToDouble(arg); return true; }
+						if( info == 31 )				{ h.kind = BinaryBreak; return true; }
+						return false;
+				}
+			}
+		}
+		return false;
+	}
+
+	//
+	// Calls chunk(data,len) for each chunk of the indefinite CBOR string whose header 'h' was read at 'p'
+	// Chunks must be definite strings of the same major type, returns the bytes used including the break or 0
+	//
+	template<class Chunk>
+	size_t ReadStringChunks(char const* p,size_t len,Format format,BinaryHeader const& h,Chunk chunk)
+	{
+		// An indefinite header has no argument bytes, so its initial byte is the last one
+		int const major	= (uint8_t)p[h.size - 1] >> 5;
+		size_t pos		= h.size;
+		while( pos < len && (uint8_t)p[pos] != 0xff )
+		{
+			BinaryHeader part;
+			if( (uint8_t)p[pos] >> 5 != major || !ReadBinaryHeader(p + pos,len - pos,format,part) || part.indefinite )
+			{
+				return 0;
+			}
+			pos	+= part.size;
+			if( len - pos < part.count )	return 0;
+			chunk(p + pos,(size_t)part.count);
+			pos	+= (size_t)part.count;
+		}
+		return pos < len ? pos + 1 : 0;
+	}
+
+	//
+	// Returns the size in bytes of the binary item at 'p', or 0 if it is malformed
+	//
+	inline size_t SkipBinary(char const* p,size_t len,Format format,int depth=0)
+	{
+		BinaryHeader h;
+		if( depth > BinaryMaxDepth || !ReadBinaryHeader(p,len,format,h) )
+		{
+			return 0;
+		}
+		size_t pos	= h.size;
+		if( h.kind == BinaryString && !h.indefinite )
+		{
+			if( len - pos < h.count )	return 0;
+			pos	+= (size_t)h.count;
+		}
+		else if( h.kind == BinaryString )
+		{
+			pos	= ReadStringChunks(p,len,format,h,[](char const*,size_t) {});
+		}
+		else if( h.kind == BinaryArray || h.kind == BinaryMap )
+		{
+			uint64_t const n	= h.indefinite ? ~(uint64_t)0 : (h.kind == BinaryMap ? h.count*2 : h.count);
+			for( uint64_t i=0; i<n; ++i )
+			{
+				if( h.indefinite && pos < len && (uint8_t)p[pos] == 0xff )
+				{
+					return pos + 1;
+				}
+				size_t const used	= SkipBinary(p + pos,len - pos,format,depth + 1);
+				if( used == 0 )	return 0;
+				pos	+= used;
+			}
+		}
+		else if( h.kind == BinaryBreak || h.kind == BinaryError )
+		{
+			return 0;
+		}
+		return pos;
+	}
+
+	//
+	// Decodes a binary scalar to a Value, containers are an error
+	//
+	Value ParseBinaryValue(char const* p,size_t len,Format format)
+	{
+		BinaryHeader h;
+		if( !ReadBinaryHeader(p,len,format,h) )
+		{
+			return Value(ValueError);
+		}
+		switch( h.kind )
+		{
+			case BinaryNull:	return Value(ValueNull);
+			case BinaryBoolean:	return Value(h.boolean);
+			case BinaryInt:		return Value((double)h.i);
+			case BinaryUInt:	return Value((double)h.u);
+			case BinaryDouble:	return Value(h.d);
+			case BinaryString:
+				if( !h.indefinite )
+				{
+					if( len - h.size < h.count )	return Value(ValueError);
+					return Value(p + h.size,(size_t)h.count);
+				}
+				else
+				{
+					// Indefinite CBOR strings are a sequence of definite chunks
+					std::string joined;
+					if( ReadStringChunks(p,len,format,h,[&](char const* sz,size_t n) { joined.append(sz,n); }) == 0 )
+					{
+						return Value(ValueError);
+					}
+					return Value(joined.c_str(),joined.length());
+				}
+			default:
+				break;
+		}
+		return Value(ValueError);
+	}
+
+	//
+	// Builds the members of 'm' from the binary item at m.str, returns the bytes used or 0 on error
+	//
+	size_t ParseBinaryItem(Member& m,size_t len,int depth)
+	{
+		BinaryHeader h;
+		if( depth > BinaryMaxDepth || !ReadBinaryHeader(m.str,len,m.format,h) )
+		{
+			return 0;
+		}
+		size_t pos	= h.size;
+		if( h.kind == BinaryArray || h.kind == BinaryMap )
+		{
+			bool const isMap	= h.kind == BinaryMap;
+			m.type	= isMap ? OBJECT : ARRAY;
+			uint64_t const n	= h.indefinite ? ~(uint64_t)0 : (isMap ? h.count*2 : h.count);
+			if( !h.indefinite && n <= len - pos )
+			{
+				m.members.reserve((size_t)n);
+			}
+			uint64_t i	= 0;
+			for( ; i<n; ++i )
+			{
+				if( h.indefinite && pos < len && (uint8_t)m.str[pos] == 0xff )
+				{
+					++pos;
+					break;
+				}
+				m.members.push_back(Member(m.str + pos,0,m.format));
+				Member& child	= m.members.back();
+				size_t used		= 0;
+				if( isMap && (i & 1) == 0 )
+				{
+					// Keys are scalars - usually strings
+					child.type	= KEY;
+					used		= SkipBinary(child.str,len - pos,m.format,depth + 1);
+					BinaryHeader key;
+					if( used == 0 || !ReadBinaryHeader(child.str,used,m.format,key) || key.kind == BinaryArray || key.kind == BinaryMap )
+					{
+						return 0;
+					}
+				}
+				else
+				{
+					used	= ParseBinaryItem(child,len - pos,depth + 1);
+				}
+				if( used == 0 )	return 0;
+				child.len	= used;
+				pos			+= used;
+				if( h.indefinite && pos >= len )	return 0;
+			}
+			if( isMap && (i & 1) != 0 )	return 0;
+		}
+		else
+		{
+			m.type	= VALUE;
+			pos		= SkipBinary(m.str,len,m.format,depth);
+			if( pos == 0 )	return 0;
+		}
+		m.len	= pos;
+		return pos;
+	}
+
+	//
+	// Subtree hashing
+	// Scalars hash their decoded value, so escapes and number formatting don't matter,
+	// objects add their key/value hashes so key order doesn't matter and arrays hash in order
+	//
+	static const uint64_t HashSeedString	= 0x9ae16a3b2f90404fULL;
+	static const uint64_t HashSeedNumber	= 0xc3a5c85c97cb3127ULL;
+	static const uint64_t HashSeedInteger	= 0x1f83d9abfb41bd6bULL;
+	static const uint64_t HashSeedNegative	= 0x5be0cd19137e2179ULL;
+	static const uint64_t HashSeedObject	= 0xb492b66fbe98f273ULL;
+	static const uint64_t HashSeedArray		= 0x9e3779b97f4a7c15ULL;
+	static const uint64_t HashSeedError		= 0x6f5e3a7c9d1b2c4dULL;
+	static const uint64_t HashTrue			= 0x2d358dccaa6c78a5ULL;
+	static const uint64_t HashFalse			= 0x8bb84b93962eacc9ULL;
+	static const uint64_t HashNull			= 0x4b33a62ed433d4a3ULL;
+
+	// MurmurHash3 finalizer
+	inline uint64_t HashMix(uint64_t h)
+	{
+		h	^= h >> 33;
+		h	*= 0xff51afd7ed558ccdULL;
+		h	^= h >> 33;
+		h	*= 0xc4ceb9fe1a85ec53ULL;
+		h	^= h >> 33;
+		return h;
+	}
+	inline uint64_t HashBytes(char const* sz,size_t len,uint64_t seed)
+	{
+		uint64_t h	= seed ^ (len * 0x87c37b91114253d5ULL);
+		size_t i	= 0;
+		for( ; i+8<=len; i+=8 )
+		{
+			uint64_t k;
+			memcpy(&k,sz + i,8);
+			k	*= 0x87c37b91114253d5ULL;
+			k	= (k << 31) | (k >> 33);
+			k	*= 0x4cf5ad432745937fULL;
+			h	^= k;
+			h	= ((h << 27) | (h >> 37)) * 5 + 0x52dce729;
+		}
+		uint64_t tail	= 0;
+		for( size_t k=0; i<len; ++i, k+=8 )
+		{
+			tail	|= (uint64_t)(uint8_t)sz[i] << k;
+		}
+		return HashMix(h ^ HashMix(tail));
+	}
+	// Integers hash exactly, so literals above 2^53 that round to the same double still differ
+	inline uint64_t HashUnsigned(uint64_t u)
+	{
+		return HashMix(u ^ HashSeedInteger);
+	}
+	inline uint64_t HashInteger(int64_t i)
+	{
+		return i >= 0 ? HashUnsigned((uint64_t)i) : HashMix((uint64_t)i ^ HashSeedNegative);
+	}
+	inline uint64_t HashNumber(double d)
+	{
+		// Integral doubles hash as the integer, so 100, 100.0 and 1e2 are equal
+		if( d == floor(d) && d >= -9223372036854775808.0 && d < 18446744073709551616.0 )
+		{
+			return d < 0 ? HashInteger((int64_t)d) : HashUnsigned((uint64_t)d);
+		}
+		uint64_t bits;
+		memcpy(&bits,&d,sizeof(bits));
+		return HashMix(bits ^ HashSeedNumber);
+	}
+
+	// The array of an empty JSON array holds a single empty value, which is not an element
+	inline bool IsEmptyValue(Member const& m)
+	{
+		return m.type==VALUE && m.format==FormatJSON && TrimLeft(m.str,m.len) >= m.len;
+	}
+
+	uint64_t HashScalar(Member const& m,std::string& scratch)
+	{
+		if( m.format == FormatJSON && m.str != nullptr )
+		{
+			size_t nLeft,nRight;
+			char const* sz	= m.str;
+			size_t szLen	= m.len;
+			if( Trim(m.str,m.len,&nLeft,&nRight) )
+			{
+				sz		+= nLeft;
+				szLen	-= (nLeft + nRight);
+			}
+			if( szLen >= 2 && *sz == '\"' && sz[szLen-1] == '\"' )
+			{
+				// Only strings with escapes need decoding
+				if( memchr(sz + 1,'\\',szLen - 2) == nullptr )
+				{
+					return HashBytes(sz + 1,szLen - 2,HashSeedString);
+				}
+				scratch.clear();
+				if( UnescapeString(sz + 1,szLen - 2,scratch) )
+				{
+					return HashBytes(scratch.c_str(),scratch.length(),HashSeedString);
+				}
+				return HashBytes(sz,szLen,HashSeedError);
+			}
+			int64_t i;
+			uint64_t u;
+			if( ParseInteger(sz,szLen,&i) )		return HashInteger(i);
+			if( ParseUnsigned(sz,szLen,&u) )	return HashUnsigned(u);
+		}
+		else if( m.format != FormatJSON && m.str != nullptr )
+		{
+			BinaryHeader h;
+			if( ReadBinaryHeader(m.str,m.len,m.format,h) )
+			{
+				if( h.kind == BinaryInt )	return HashInteger(h.i);
+				if( h.kind == BinaryUInt )	return HashUnsigned(h.u);
+			}
+		}
+		Value v	= m.GetValue();
+		switch( v.GetType() )
+		{
+			case ValueNull:		return HashNull;
+			case ValueString:	return HashBytes(v.AsString(),v.len,HashSeedString);
+			case ValueNumber:	return HashNumber(v.AsDouble());
+			case ValueBoolean:	return v.AsBoolean() ? HashTrue : HashFalse;
+			default:			break;
+		}
+		return HashBytes(m.str,m.len,HashSeedError);
+	}
+
+	//
+	// Combines the hashes of the children of 'm', as given by childHash(child)
+	//
+	template<class ChildHash>
+	uint64_t CombineHash(Member const& m,std::string& scratch,ChildHash childHash)
+	{
+		if( m.type == OBJECT )
+		{
+			uint64_t sum	= 0;
+			for( size_t i=0; i+1<m.members.size(); i+=2 )
+			{
+				sum	+= HashMix(childHash(m.members[i]) * 0x9e3779b97f4a7c15ULL ^ childHash(m.members[i+1]));
+			}
+			return HashMix(sum ^ HashSeedObject);
+		}
+		if( m.type == ARRAY )
+		{
+			uint64_t h	= HashSeedArray;
+			for( Member const& child : m.members )
+			{
+				if( !IsEmptyValue(child) )
+				{
+					h	= HashMix(h * 31 + childHash(child));
+				}
+			}
+			for( Member::V2 const& v : m.values )
+			{
+				Member span(v.str,v.len,m.format);
+				span.type	= VALUE;
+				h	= HashMix(h * 31 + HashScalar(span,scratch));
+			}
+			return h;
+		}
+		return HashScalar(m,scratch);
+	}
+	// Sets m.hash from its already hashed children
+	void HashMember(Member& m,std::string& scratch)
+	{
+		m.hash	= CombineHash(m,scratch,[](Member const& child) { return child.hash; });
+	}
+	// The hash HashTree would store, for trees parsed without ParseHash
+	uint64_t ComputeHash(Member const& m,std::string& scratch)
+	{
+		return CombineHash(m,scratch,[&](Member const& child) { return ComputeHash(child,scratch); });
+	}
+	void HashTree(Member& m,std::string& scratch)
+	{
+		for( Member& child : m.members )
+		{
+			HashTree(child,scratch);
+		}
+		HashMember(m,scratch);
+	}
+
+
+	//
+	// Diff helpers
+	//
+	std::string DiffKey(Member const& key)
+	{
+		Value v	= key.GetValue();
+		if( v.IsString() )	return std::string(v.AsString(),v.len);
+		if( v.IsNumber() )
+		{
+			// Binary formats allow integer keys
+			BinaryHeader h;
+			if( ReadBinaryHeader(key.str,key.len,key.format,h) )
+			{
+				if( h.kind == BinaryInt )	return std::to_string(h.i);
+				if( h.kind == BinaryUInt )	return std::to_string(h.u);
+			}
+			char buf[32];
+			snprintf(buf,sizeof(buf),"%.17g",v.AsDouble());
+			return buf;
+		}
+		return std::string(key.str,key.len);
+	}
+	// JSON Pointer escaping - '~' is "~0" and '/' is "~1"
+	void DiffAppendPath(std::string& path,std::string const& token)
+	{
+		path	+= '/';
+		for( char ch : token )
+		{
+			if( ch == '~' )			path += "~0";
+			else if( ch == '/' )	path += "~1";
+			else					path += ch;
+		}
+	}
+	void DiffAdd(std::vector<Difference>& differences,DiffType type,std::string const& path,Member const* before,Member const* after)
+	{
+		Difference d;
+		d.type		= type;
+		d.path		= path;
+		d.before	= before;
+		d.after		= after;
+		differences.push_back(d);
+	}
+
+	void DiffMembers(Member const& a,Member const& b,std::string& path,std::vector<Difference>& differences,bool hashed,std::string& scratch)
+	{
+		auto Hash	= [&](Member const& m) -> uint64_t
+		{
+			return hashed ? m.hash : ComputeHash(m,scratch);
+		};
+		if( Hash(a) == Hash(b) )
+		{
+			return;
+		}
+		size_t const pathLen	= path.length();
+		if( a.type==OBJECT && b.type==OBJECT )
+		{
+			// Index the keys of 'b' so unchanged key order isn't required
+			std::unordered_map<std::string,size_t> index;
+			for( size_t i=0; i+1<b.members.size(); i+=2 )
+			{
+				index[DiffKey(b.members[i])]	= i;
+			}
+			std::vector<bool> matched(b.members.size(),false);
+			for( size_t i=0; i+1<a.members.size(); i+=2 )
+			{
+				std::string const key	= DiffKey(a.members[i]);
+				DiffAppendPath(path,key);
+				auto found	= index.find(key);
+				if( found == index.end() )
+				{
+					DiffAdd(differences,DiffRemoved,path,&a.members[i+1],nullptr);
+				}
+				else
+				{
+					matched[found->second]	= true;
+					DiffMembers(a.members[i+1],b.members[found->second + 1],path,differences,hashed,scratch);
+				}
+				path.resize(pathLen);
+			}
+			for( size_t i=0; i+1<b.members.size(); i+=2 )
+			{
+				if( !matched[i] )
+				{
+					DiffAppendPath(path,DiffKey(b.members[i]));
+					DiffAdd(differences,DiffAdded,path,nullptr,&b.members[i+1]);
+					path.resize(pathLen);
+				}
+			}
+		}
+		else if( a.type==ARRAY && b.type==ARRAY && a.values.empty() && b.values.empty() )
+		{
+			std::vector<Member const*> ea,eb;
+			for( Member const& m : a.members )	if( !IsEmptyValue(m) ) ea.push_back(&m);
+			for( Member const& m : b.members )	if( !IsEmptyValue(m) ) eb.push_back(&m);
+			size_t const n	= ea.size() > eb.size() ? ea.size() : eb.size();
+			for( size_t i=0; i<n; ++i )
+			{
+				DiffAppendPath(path,std::to_string(i));
+				if( i >= eb.size() )		DiffAdd(differences,DiffRemoved,path,ea[i],nullptr);
+				else if( i >= ea.size() )	DiffAdd(differences,DiffAdded,path,nullptr,eb[i]);
+				else						DiffMembers(*ea[i],*eb[i],path,differences,hashed,scratch);
+				path.resize(pathLen);
+			}
+		}
+		else if( a.type==ARRAY && b.type==ARRAY )
+		{
+			// Elements of compact arrays have no Member, so the arrays are reported with the element path
+			auto ElementHash	= [&](Member const& m,size_t i) -> uint64_t
+			{
+				if( m.values.empty() )	return Hash(m.members[i]);
+				Member span(m.values[i].str,m.values[i].len,m.format);
+				span.type	= VALUE;
+				return HashScalar(span,scratch);
+			};
+			size_t const na	= a.Size();
+			size_t const nb	= b.Size();
+			size_t const n	= na > nb ? na : nb;
+			for( size_t i=0; i<n; ++i )
+			{
+				DiffAppendPath(path,std::to_string(i));
+				if( i >= nb )		DiffAdd(differences,DiffRemoved,path,&a,nullptr);
+				else if( i >= na )	DiffAdd(differences,DiffAdded,path,nullptr,&b);
+				else if( ElementHash(a,i) != ElementHash(b,i) )	DiffAdd(differences,DiffChanged,path,&a,&b);
+				path.resize(pathLen);
+			}
+		}
+		else
+		{
+			DiffAdd(differences,DiffChanged,path,&a,&b);
+		}
+	}
+
+	void Diff(Member const& before,Member const& after,std::vector<Difference>& differences)
+	{
+		std::string path;
+		std::string scratch;
+		// A tree parsed with ParseHash has a non-zero root hash, others are hashed here as they are compared
+		bool const hashed	= before.hash != 0 && after.hash != 0;
+		DiffMembers(before,after,path,differences,hashed,scratch);
+	}
+
+	bool ParseBinary(Member& root)
+	{
+		if( root.str == nullptr || root.len == 0 )
+		{
+			return false;
+		}
+		root.members.clear();
+		size_t const len	= root.len;
+		return ParseBinaryItem(root,len,0) == len;
+	}
+
+
+	//
+	// Writers share one interface so the readers below can produce any format
+	// Begin returns a mark that is passed back to End along with the number of items written
+	//
+	static const size_t UnknownCount	= (size_t)-1;
+
+	struct JsonWriter
+	{
+		JsonWriter(std::string& o) : out(o),start(o.length()) {}
+
+		void Null()								{ Separate(); out += "null"; }
+		void Boolean(bool b)					{ Separate(); out += b ? "true" : "false"; }
+		void Int(int64_t v)						{ Separate(); out += std::to_string(v); }
+		void UInt(uint64_t v)					{ Separate(); out += std::to_string(v); }
+		void Double(double v)
+		{
+			Separate();
+			if( v != v || v == HUGE_VAL || v == -HUGE_VAL )
+			{
+				out	+= "null";
+				return;
+			}
+			// Use the shortest form that reads back to the same value
+			char buf[32];
+			snprintf(buf,sizeof(buf),"%.15g",v);
+			if( strtod(buf,nullptr) != v )
+			{
+				snprintf(buf,sizeof(buf),"%.17g",v);
+			}
+			out	+= buf;
+			if( strpbrk(buf,".eE") == nullptr )
+			{
+				out	+= ".0";
+			}
+		}
+		void String(char const* sz,size_t len)	{ Separate(); Quoted(sz,len); }
+		void Key(char const* sz,size_t len)		{ Separate(); Quoted(sz,len); out += ':'; }
+		size_t BeginObject(size_t =UnknownCount)	{ Separate(); out += '{'; return 0; }
+		size_t BeginArray(size_t =UnknownCount)		{ Separate(); out += '['; return 0; }
+		void EndObject(size_t,size_t)			{ out += '}'; }
+		void EndArray(size_t,size_t)			{ out += ']'; }
+
+		void Separate()
+		{
+			if( out.length() > start )
+			{
+				char const c	= out.back();
+				if( c!='{' && c!='[' && c!=':' )
+				{
+					out	+= ',';
+				}
+			}
+		}
+		void Quoted(char const* sz,size_t len)
+		{
+			static const char hex[]	= "0123456789abcdef";
+			out	+= '\"';
+			for( size_t i=0; i<len; ++i )
+			{
+				char const ch	= sz[i];
+				if( ch == '\"' )		{ out += "\\\""; }
+				else if( ch == '\\' )	{ out += "\\\\"; }
+				else if( ch == '\b' )	{ out += "\\b"; }
+				else if( ch == '\f' )	{ out += "\\f"; }
+				else if( ch == '\n' )	{ out += "\\n"; }
+				else if( ch == '\r' )	{ out += "\\r"; }
+				else if( ch == '\t' )	{ out += "\\t"; }
+				else if( (uint8_t)ch < 0x20 )
+				{
+					out	+= "\\u00";
+					out	+= hex[(uint8_t)ch >> 4];
+					out	+= hex[ch & 0xf];
+				}
+				else					{ out += ch; }
+			}
+			out	+= '\"';
+		}
+
+		std::string&	out;
+		size_t			start;
+	};
+
+	struct BinaryWriter
+	{
+		BinaryWriter(std::string& o,Format f) : out(o),format(f) {}
+
+		void Null()				{ out += (char)(format == FormatMsgPack ? 0xc0 : 0xf6); }
+		void Boolean(bool b)
+		{
+			if( format == FormatMsgPack )	out += (char)(b ? 0xc3 : 0xc2);
+			else							out += (char)(b ? 0xf5 : 0xf4);
+		}
+		void Int(int64_t v)
+		{
+			if( v >= 0 )
+			{
+				UInt((uint64_t)v);
+			}
+			else if( format == FormatCBOR )
+			{
+				Head(1,(uint64_t)(-1 - v));
+			}
+			else if( v >= -32 )			{ out += (char)(int8_t)v; }
+			else if( v >= INT8_MIN )	{ out += (char)0xd0; WriteBigEndian(out,(uint64_t)v,1); }
+			else if( v >= INT16_MIN )	{ out += (char)0xd1; WriteBigEndian(out,(uint64_t)v,2); }
+			else if( v >= INT32_MIN )	{ out += (char)0xd2; WriteBigEndian(out,(uint64_t)v,4); }
+			else						{ out += (char)0xd3; WriteBigEndian(out,(uint64_t)v,8); }
+		}
+		void UInt(uint64_t v)
+		{
+			if( format == FormatCBOR )	{ Head(0,v); }
+			else if( v <= 0x7f )		{ out += (char)v; }
+			else if( v <= 0xff )		{ out += (char)0xcc; WriteBigEndian(out,v,1); }
+			else if( v <= 0xffff )		{ out += (char)0xcd; WriteBigEndian(out,v,2); }
+			else if( v <= 0xffffffff )	{ out += (char)0xce; WriteBigEndian(out,v,4); }
+			else						{ out += (char)0xcf; WriteBigEndian(out,v,8); }
+		}
+		void Double(double v)
+		{
+			uint64_t bits;
+			memcpy(&bits,&v,sizeof(bits));
+			out	+= (char)(format == FormatMsgPack ? 0xcb : 0xfb);
+			WriteBigEndian(out,bits,8);
+		}
+		void String(char const* sz,size_t len)
+		{
+			if( format == FormatCBOR )	{ Head(3,len); }
+			else if( len < 32 )			{ out += (char)(0xa0 | len); }
+			else if( len <= 0xff )		{ out += (char)0xd9; WriteBigEndian(out,len,1); }
+			else if( len <= 0xffff )	{ out += (char)0xda; WriteBigEndian(out,len,2); }
+			else						{ out += (char)0xdb; WriteBigEndian(out,len,4); }
+			out.append(sz,len);
+		}
+		void Key(char const* sz,size_t len)	{ String(sz,len); }
+
+		size_t BeginObject(size_t count=UnknownCount)	{ return Container(5,0x80,0xde,count); }
+		size_t BeginArray(size_t count=UnknownCount)	{ return Container(4,0x90,0xdc,count); }
+		void EndObject(size_t mark,size_t count)		{ Patch(mark,count); }
+		void EndArray(size_t mark,size_t count)			{ Patch(mark,count); }
+
+		// CBOR initial byte and argument in the shortest form
+		void Head(int major,uint64_t arg)
+		{
+			uint8_t const m	= (uint8_t)(major << 5);
+			if( arg < 24 )					{ out += (char)(m | arg); }
+			else if( arg <= 0xff )			{ out += (char)(m | 24); WriteBigEndian(out,arg,1); }
+			else if( arg <= 0xffff )		{ out += (char)(m | 25); WriteBigEndian(out,arg,2); }
+			else if( arg <= 0xffffffff )	{ out += (char)(m | 26); WriteBigEndian(out,arg,4); }
+			else							{ out += (char)(m | 27); WriteBigEndian(out,arg,8); }
+		}
+		// When the count is unknown a 32 bit placeholder is written and patched by End
+		size_t Container(int major,uint8_t fix,uint8_t type16,size_t count)
+		{
+			if( count == UnknownCount )
+			{
+				size_t const mark	= out.length();
+				out	+= (char)(format == FormatCBOR ? ((major << 5) | 26) : type16 + 1);
+				WriteBigEndian(out,0,4);
+				return mark;
+			}
+			if( format == FormatCBOR )	{ Head(major,count); }
+			else if( count < 16 )		{ out += (char)(fix | count); }
+			else if( count <= 0xffff )	{ out += (char)type16; WriteBigEndian(out,count,2); }
+			else						{ out += (char)(type16 + 1); WriteBigEndian(out,count,4); }
+			return UnknownCount;
+		}
+		void Patch(size_t mark,size_t count)
+		{
+			if( mark != UnknownCount )
+			{
+				for( int i=0; i<4; ++i )
+				{
+					out[mark + 1 + i]	= (char)((count >> ((3-i)*8)) & 0xff);
+				}
+			}
+		}
+
+		std::string&	out;
+		Format			format;
+	};
+
+
+	//
+	// Forwards parse events to a writer, tracking the item count of each open container
+	//
+	template<class Writer>
+	struct WriterEvents : EventHandler<WriterEvents<Writer>>
+	{
+		struct Open
+		{
+			size_t	mark;
+			size_t	count;
+			bool	object;
+		};
+
+		WriterEvents(Writer& writer) : w(writer) {}
+
+		bool OnNull()							{ Item(); w.Null(); return true; }
+		bool OnBoolean(bool b)					{ Item(); w.Boolean(b); return true; }
+		bool OnNumber(double v)					{ Item(); w.Double(v); return true; }
+		bool OnInteger(int64_t v)				{ Item(); w.Int(v); return true; }
+		bool OnUnsigned(uint64_t v)				{ Item(); w.UInt(v); return true; }
+		bool OnString(char const* sz,size_t len)	{ Item(); w.String(sz,len); return true; }
+		bool OnKey(char const* sz,size_t len)
+		{
+			open.back().count++;
+			w.Key(sz,len);
+			return true;
+		}
+		bool OnStartObject()
+		{
+			Item();
+			Open const o	= { w.BeginObject(), 0, true };
+			open.push_back(o);
+			return true;
+		}
+		bool OnStartArray()
+		{
+			Item();
+			Open const o	= { w.BeginArray(), 0, false };
+			open.push_back(o);
+			return true;
+		}
+		bool OnEndObject()	{ w.EndObject(open.back().mark,open.back().count); open.pop_back(); return true; }
+		bool OnEndArray()	{ w.EndArray(open.back().mark,open.back().count); open.pop_back(); return true; }
+
+		// Object members are counted by their key
+		void Item()
+		{
+			if( !open.empty() && !open.back().object )
+			{
+				open.back().count++;
+			}
+		}
+
+		Writer&				w;
+		std::vector<Open>	open;
+	};
+
+	//
+	// Reads a single binary item and writes it to 'w', returns the bytes used or 0 on error
+	//
+	template<class Writer>
+	size_t ReadBinary(char const* p,size_t len,Format format,Writer& w,int depth)
+	{
+		BinaryHeader h;
+		if( depth > BinaryMaxDepth || !ReadBinaryHeader(p,len,format,h) )
+		{
+			return 0;
+		}
+		size_t pos	= h.size;
+		switch( h.kind )
+		{
+			case BinaryNull:	w.Null(); break;
+			case BinaryBoolean:	w.Boolean(h.boolean); break;
+			case BinaryInt:		w.Int(h.i); break;
+			case BinaryUInt:	w.UInt(h.u); break;
+			case BinaryDouble:	w.Double(h.d); break;
+			case BinaryString:
+			{
+				if( h.indefinite )
+				{
+					Value v	= ParseBinaryValue(p,len,format);
+					if( !v.IsString() )	return 0;
+					w.String(v.AsString(),v.len);
+					return SkipBinary(p,len,format,depth);
+				}
+				if( len - pos < h.count )	return 0;
+				w.String(p + pos,(size_t)h.count);
+				pos	+= (size_t)h.count;
+				break;
+			}
+			case BinaryArray:
+			case BinaryMap:
+			{
+				bool const isMap	= h.kind == BinaryMap;
+				size_t const known	= h.indefinite ? UnknownCount : (size_t)h.count;
+				size_t const mark	= isMap ? w.BeginObject(known) : w.BeginArray(known);
+				uint64_t const n	= h.indefinite ? ~(uint64_t)0 : h.count;
+				size_t count		= 0;
+				for( uint64_t i=0; i<n; ++i )
+				{
+					if( h.indefinite && pos < len && (uint8_t)p[pos] == 0xff )
+					{
+						++pos;
+						break;
+					}
+					if( isMap )
+					{
+						// JSON only has string keys, so integer keys are written as text
+						BinaryHeader key;
+						if( !ReadBinaryHeader(p + pos,len - pos,format,key) )	return 0;
+						if( key.kind == BinaryString )
+						{
+							Value v	= ParseBinaryValue(p + pos,len - pos,format);
+							if( !v.IsString() )	return 0;
+							w.Key(v.AsString(),v.len);
+						}
+						else if( key.kind == BinaryInt || key.kind == BinaryUInt )
+						{
+							std::string const text	= key.kind == BinaryInt ? std::to_string(key.i) : std::to_string(key.u);
+							w.Key(text.c_str(),text.length());
+						}
+						else
+						{
+							return 0;
+						}
+						size_t const used	= SkipBinary(p + pos,len - pos,format,depth + 1);
+						if( used == 0 )	return 0;
+						pos	+= used;
+					}
+					size_t const used	= ReadBinary(p + pos,len - pos,format,w,depth + 1);
+					if( used == 0 )	return 0;
+					pos	+= used;
+					++count;
+					if( h.indefinite && pos >= len )	return 0;
+				}
+				if( isMap )	w.EndObject(mark,count);
+				else		w.EndArray(mark,count);
+				break;
+			}
+			default:
+				return 0;
+		}
+		return pos;
+	}
+
+	bool Transcode(char const* src,size_t len,Format from,Format to,std::string& out)
+	{
+		if( src == nullptr || len == 0 )	return false;
+		size_t const start	= out.length();
+		bool ok	= false;
+		if( from == FormatJSON )
+		{
+			if( to == FormatJSON )
+			{
+				JsonWriter w(out);
+				WriterEvents<JsonWriter> events(w);
+				ok	= ParseEvents(src,len,events);
+			}
+			else
+			{
+				BinaryWriter w(out,to);
+				WriterEvents<BinaryWriter> events(w);
+				ok	= ParseEvents(src,len,events);
+			}
+		}
+		else
+		{
+			if( to == FormatJSON )
+			{
+				JsonWriter w(out);
+				ok	= ReadBinary(src,len,from,w,0) == len;
+			}
+			else
+			{
+				BinaryWriter w(out,to);
+				ok	= ReadBinary(src,len,from,w,0) == len;
+			}
+		}
+		if( !ok )
+		{
+			out.resize(start);
+		}
+		return ok;
+	}
+
+	//
+	// Minify and Prettify
+	// Runs of string content and of value characters are found 8 bytes at a time and copied in one go
+	//
+	static const uint64_t SwarOnes	= 0x0101010101010101ULL;
+	static const uint64_t SwarHighs	= 0x8080808080808080ULL;
+
+	inline uint64_t SwarLoad(char const* p)
+	{
+		uint64_t w;
+		memcpy(&w,p,8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+		w	= __builtin_bswap64(w);
+#endif
+		return w;
+	}
+	// The high bit of a byte is set where 'w' has byte 'b', or a byte below 'b'
+	// Bytes above the first match can be set falsely, so only the first one is used
+	inline uint64_t SwarEqual(uint64_t w,uint8_t b)
+	{
+		uint64_t const x	= w ^ (SwarOnes * b);
+		return (x - SwarOnes) & ~x & SwarHighs;
+	}
+	inline uint64_t SwarLess(uint64_t w,uint8_t b)
+	{
+		return (w - SwarOnes * b) & ~w & SwarHighs;
+	}
+	inline size_t SwarFirst(uint64_t mask)
+	{
+#if defined(__GNUC__)
+		return (size_t)__builtin_ctzll(mask) >> 3;
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+		unsigned long index;
+		_BitScanForward64(&index,mask);
+		return (size_t)index >> 3;
+#else
+		size_t byte	= 0;
+		while( (mask & 0x80) == 0 )
+		{
+			mask	>>= 8;
+			++byte;
+		}
+		return byte;
+#endif
+	}
+
+	// First quote or backslash, the end of a run of string content
+	inline char const* FindStringEnd(char const* p,char const* end)
+	{
+		for( ; end-p >= 8; p += 8 )
+		{
+			uint64_t const w	= SwarLoad(p);
+			uint64_t const mask	= SwarEqual(w,'\"') | SwarEqual(w,'\\');
+			if( mask )	return p + SwarFirst(mask);
+		}
+		while( p<end && *p!='\"' && *p!='\\' )	++p;
+		return p;
+	}
+
+	// First quote, whitespace or control character, the end of a run that Minify keeps as it is
+	inline char const* FindMinifyBreak(char const* p,char const* end)
+	{
+		for( ; end-p >= 8; p += 8 )
+		{
+			uint64_t const w	= SwarLoad(p);
+			uint64_t const mask	= SwarEqual(w,'\"') | SwarLess(w,0x21);
+			if( mask )	return p + SwarFirst(mask);
+		}
+		while( p<end && *p!='\"' && (uint8_t)*p > 0x20 )	++p;
+		return p;
+	}
+
+	// Returns the character after the closing quote of the string at 'p', or nullptr if it is unterminated
+	inline char const* FindStringClose(char const* p,char const* end)
+	{
+		++p;
+		for( ;; )
+		{
+			p	= FindStringEnd(p,end);
+			if( p == end )	return nullptr;
+			if( *p == '\"' )	return p + 1;
+			if( end-p < 2 )	return nullptr;
+			p	+= 2;	// the escaped character cannot end the string
+		}
+	}
+
+	// Writes the minified 'src' to 'dst', which may be 'src' itself, and returns its length or SIZE_MAX on failure
+	inline size_t MinifyTo(char const* src,size_t len,char* dst)
+	{
+		char const* p	= src;
+		char const* end	= src + len;
+		char* out		= dst;
+		while( p < end )
+		{
+			char const* run	= p;
+			if( *p == '\"' )
+			{
+				p	= FindStringClose(p,end);
+				if( p == nullptr )	return SIZE_MAX;
+			}
+			else
+			{
+				p	= FindMinifyBreak(p,end);
+			}
+			if( out != run )	memmove(out,run,p - run);
+			out	+= p - run;
+
+			while( p<end && (*p==' ' || *p=='\n' || *p=='\r' || *p=='\t') )	++p;
+			if( p<end && (uint8_t)*p < 0x20 )	return SIZE_MAX;
+		}
+		return out - dst;
+	}
+
+	bool Minify(char const* src,size_t len,std::string& out)
+	{
+		if( src == nullptr )	return false;
+		size_t const start	= out.length();
+		out.resize(start + len);
+		size_t const written	= MinifyTo(src,len,&out[start]);
+		out.resize(written == SIZE_MAX ? start : start + written);
+		return written != SIZE_MAX;
+	}
+
+	bool Minify(char* src,size_t* len)
+	{
+		if( src == nullptr || len == nullptr )	return false;
+		size_t const written	= MinifyTo(src,*len,src);
+		if( written == SIZE_MAX )	return false;
+		*len	= written;
+		return true;
+	}
+
+	bool Prettify(char const* src,size_t len,std::string& out,int indent)
+	{
+		if( src == nullptr )	return false;
+		size_t const start	= out.length();
+		size_t const step	= indent > 0 ? (size_t)indent : 0;
+		std::string open;	// brackets of the containers being written
+		char const* p	= src;
+		char const* end	= src + len;
+		out.reserve(start + len + len / 2);
+
+		auto NewLine	= [&]()
+		{
+			out	+= '\n';
+			out.append(open.size() * step,' ');
+		};
+		auto SkipSpace	= [&]()
+		{
+			while( p<end && (*p==' ' || *p=='\n' || *p=='\r' || *p=='\t') )	++p;
+		};
+
+		bool ok	= true;
+		while( ok && p < end )
+		{
+			char const ch	= *p;
+			switch( ch )
+			{
+				case ' ':
+				case '\n':
+				case '\r':
+				case '\t':
+					++p;
+					break;
+				case '\"':
+				{
+					char const* close	= FindStringClose(p,end);
+					if( close == nullptr )
+					{
+						ok	= false;
+						break;
+					}
+					out.append(p,close - p);
+					p	= close;
+					break;
+				}
+				case '{':
+				case '[':
+					out	+= ch;
+					++p;
+					SkipSpace();
+					// Empty containers stay on one line
+					if( p<end && *p == (ch == '{' ? '}' : ']') )
+					{
+						out	+= *p++;
+						break;
+					}
+					open	+= ch;
+					NewLine();
+					break;
+				case '}':
+				case ']':
+					if( open.empty() || open.back() != (ch == '}' ? '{' : '[') )
+					{
+						ok	= false;
+						break;
+					}
+					open.pop_back();
+					NewLine();
+					out	+= ch;
+					++p;
+					break;
+				case ',':
+					out	+= ',';
+					++p;
+					NewLine();
+					break;
+				case ':':
+					out	+= ':';
+					out	+= ' ';
+					++p;
+					break;
+				default:
+				{
+					if( (uint8_t)ch < 0x20 )
+					{
+						ok	= false;
+						break;
+					}
+					// Numbers and literals, up to the next delimiter
+					char const* run	= p;
+					while( p<end && (uint8_t)*p > 0x20 && *p!=',' && *p!=']' && *p!='}' && *p!=':' && *p!='\"' && *p!='[' && *p!='{' )	++p;
+					out.append(run,p - run);
+					break;
+				}
+			}
+		}
+		if( !ok || !open.empty() )
+		{
+			out.resize(start);
+			return false;
+		}
+		return true;
+	}
+
+	Value Member::GetValue() const
+	{
+		if( str==nullptr || len==0 )
+		{
+			return Value(ValueNull);
+		}
+		if( format != FormatJSON )
+		{
+			return ParseBinaryValue(str,len,format);
+		}
+		// Iterator
+		size_t nLeft,nRight;
+		size_t szLen = len;
+		char const* sz = str;
+		if( Trim(str, len, &nLeft, &nRight) )
+		{
+			sz		+= nLeft;
+			szLen	-= (nLeft + nRight);
+		}
+
+		if( *sz == '\"' )
+		{
+			if( szLen < 2 )
+			{
+				return Value(ValueError);
+			}
+			sz++;
+			szLen	-= 2;
+			if( *(sz+szLen) != '\"' )
+			{
+				// No closing quote
+				return Value(ValueError);
+			}
+			return ParseString(sz,szLen);
+		}
+
+		static char szTrue[]	= {'t','r','u','e',0};
+		static char szFalse[]	= {'f','a','l','s','e'};
+		static char szNull[]	= {'n','u','l','l',0};
+		int nTrue	= 0;
+		int nFalse	= 0;
+		int nNull	= 0;
+		for( size_t i=0; i<5 && i<szLen; ++i )
+		{
+			if( *(sz+i) == szTrue[i] )	nTrue++;
+			if( *(sz+i) == szFalse[i] )	nFalse++;
+			if( *(sz+i) == szNull[i] )	nNull++;
+		}
+		if( nTrue==4 )	return Value(true);
+		if( nFalse==5 )	return Value(false);
+		if( nNull==4 )	return Value(ValueNull);
+
+		double fast;
+		if( ParseDouble(sz,szLen,&fast) )
+		{
+			return Value(fast);
+		}
+
+		char* pEnd;
+		errno		= 0;
+		double num	= strtod(sz,&pEnd);
+		if( errno == ERANGE || pEnd==str )
+		{
+			return Value(ValueError);
+		}
+		return Value(num);
+	}
+
+	Value Member::GetValue(size_t index) const
+	{
+		if( index < values.size() )
+		{
+			Member span(values[index].str,values[index].len,format);
+			span.type	= VALUE;
+			return span.GetValue();
+		}
+		if( type == ARRAY && values.empty() && index < Size() )
+		{
+			return members[index].GetValue();
+		}
+		return Value(ValueError);
+	}
+
+	size_t Member::Size() const
+	{
+		if( type == ARRAY )
+		{
+			if( !values.empty() )	return values.size();
+			if( members.size() == 1 && IsEmptyValue(members[0]) )	return 0;
+			return members.size();
+		}
+		if( type == OBJECT )
+		{
+			return members.size() / 2;
+		}
+		return 0;
+	}
+
+	//
+	// Bulk numeric decoding
+	//
+	inline void TrimSpan(char const*& sz,size_t& len)
+	{
+		while( len>0 && (*sz==' ' || *sz=='\n' || *sz=='\r' || *sz=='\t') )
+		{
+			++sz;
+			--len;
+		}
+		while( len>0 && (sz[len-1]==' ' || sz[len-1]=='\n' || sz[len-1]=='\r' || sz[len-1]=='\t') )
+		{
+			--len;
+		}
+	}
+	inline bool DecodeNumber(char const* sz,size_t len,double* out)
+	{
+		TrimSpan(sz,len);
+		return ParseDouble(sz,len,out);
+	}
+	inline bool DecodeIntegral(double d,int64_t* out)
+	{
+		if( d != floor(d) || d < -9223372036854775808.0 || d >= 9223372036854775808.0 )
+		{
+			return false;
+		}
+		*out	= (int64_t)d;
+		return true;
+	}
+	inline bool DecodeNumber(char const* sz,size_t len,int64_t* out)
+	{
+		TrimSpan(sz,len);
+		if( ParseInteger(sz,len,out) )	return true;
+		// Integral values written with a fraction or exponent
+		double d;
+		return ParseDouble(sz,len,&d) && DecodeIntegral(d,out);
+	}
+	inline bool DecodeNumber(Value const& v,double* out)
+	{
+		if( !v.IsNumber() )	return false;
+		*out	= v.AsDouble();
+		return true;
+	}
+	inline bool DecodeNumber(Value const& v,int64_t* out)
+	{
+		return v.IsNumber() && DecodeIntegral(v.AsDouble(),out);
+	}
+
+	template<class T>
+	bool DecodeArray(Member const& m,T* out,size_t capacity,size_t* count)
+	{
+		size_t const n	= m.Size();
+		*count	= 0;
+		if( m.type != ARRAY || n > capacity )
+		{
+			return false;
+		}
+		if( !m.values.empty() )
+		{
+			for( size_t i=0; i<n; ++i )
+			{
+				if( !DecodeNumber(m.values[i].str,m.values[i].len,&out[i]) )	return false;
+			}
+		}
+		else
+		{
+			for( size_t i=0; i<n; ++i )
+			{
+				Member const& e	= m.members[i];
+				if( e.format == FormatJSON )
+				{
+					if( e.type != VALUE || !DecodeNumber(e.str,e.len,&out[i]) )	return false;
+				}
+				else if( !DecodeNumber(e.GetValue(),&out[i]) )
+				{
+					return false;
+				}
+			}
+		}
+		*count	= n;
+		return true;
+	}
+
+	template<> bool Member::GetArray<double>(double* out,size_t capacity,size_t* count) const
+	{
+		return DecodeArray(*this,out,capacity,count);
+	}
+	template<> bool Member::GetArray<int64_t>(int64_t* out,size_t capacity,size_t* count) const
+	{
+		return DecodeArray(*this,out,capacity,count);
+	}
+	template<> bool Member::GetArray<double>(std::vector<double>& out) const
+	{
+		size_t count;
+		out.resize(Size());
+		bool const ok	= DecodeArray(*this,out.data(),out.size(),&count);
+		out.resize(count);
+		return ok;
+	}
+	template<> bool Member::GetArray<int64_t>(std::vector<int64_t>& out) const
+	{
+		size_t count;
+		out.resize(Size());
+		bool const ok	= DecodeArray(*this,out.data(),out.size(),&count);
+		out.resize(count);
+		return ok;
+	}
+
+	//
+	// Columnar extraction
+	//
+	inline bool ColumnView(Member const& m,Member::V2& view)
+	{
+		if( m.format != FormatJSON )
+		{
+			BinaryHeader h;
+			if( !ReadBinaryHeader(m.str,m.len,m.format,h) || h.kind != BinaryString || h.indefinite || m.len - h.size < h.count )
+			{
+				return false;
+			}
+			view.str	= m.str + h.size;
+			view.len	= (size_t)h.count;
+			return true;
+		}
+		char const* sz	= m.str;
+		size_t len		= m.len;
+		TrimSpan(sz,len);
+		if( len < 2 || sz[0] != '\"' || sz[len-1] != '\"' )
+		{
+			return false;
+		}
+		view.str	= sz + 1;
+		view.len	= len - 2;
+		return true;
+	}
+
+	inline bool ColumnKeyMatches(Member const& key,std::string const& name)
+	{
+		Member::V2 view;
+		if( !ColumnView(key,view) )	return false;
+		if( key.format == FormatJSON && memchr(view.str,'\\',view.len) != nullptr )
+		{
+			std::string unescaped;
+			return UnescapeString(view.str,view.len,unescaped) && unescaped == name;
+		}
+		return view.len == name.length() && memcmp(view.str,name.data(),view.len) == 0;
+	}
+
+	// Index of the key in an object, or SIZE_MAX
+	inline size_t ColumnKeyIndex(Member const& object,std::string const& name)
+	{
+		for( size_t i=0; i+1<object.members.size(); ++i )
+		{
+			if( object.members[i].type == KEY && ColumnKeyMatches(object.members[i],name) )
+			{
+				return i;
+			}
+		}
+		return SIZE_MAX;
+	}
+
+	inline Member const* ColumnField(Member const& object,std::string const& name,size_t hint)
+	{
+		if( object.type != OBJECT )
+		{
+			return nullptr;
+		}
+		if( hint < object.members.size() && hint+1 < object.members.size() && object.members[hint].type == KEY && ColumnKeyMatches(object.members[hint],name) )
+		{
+			return &object.members[hint+1];
+		}
+		size_t const i	= ColumnKeyIndex(object,name);
+		return i != SIZE_MAX ? &object.members[i+1] : nullptr;
+	}
+
+	// Splits a JSON Pointer into unescaped tokens
+	inline bool ColumnPath(std::string const& path,std::vector<std::string>& tokens)
+	{
+		tokens.clear();
+		if( path.empty() )	return true;
+		if( path[0] != '/' )	return false;
+		for( size_t i=0; i<path.length(); ++i )
+		{
+			if( path[i] == '/' )
+			{
+				tokens.push_back(std::string());
+			}
+			else if( path[i] == '~' )
+			{
+				if( i+1 >= path.length() || (path[i+1] != '0' && path[i+1] != '1') )	return false;
+				tokens.back()	+= path[++i] == '0' ? '~' : '/';
+			}
+			else
+			{
+				tokens.back()	+= path[i];
+			}
+		}
+		return true;
+	}
+
+	inline bool ColumnStore(Column& column,size_t row,Member const& m)
+	{
+		if( m.type != VALUE )
+		{
+			return false;
+		}
+		switch( column.type )
+		{
+			case ColumnDouble:
+				if( m.format == FormatJSON )	return DecodeNumber(m.str,m.len,&column.doubles[row]);
+				return DecodeNumber(m.GetValue(),&column.doubles[row]);
+			case ColumnInt64:
+				if( m.format == FormatJSON )	return DecodeNumber(m.str,m.len,&column.integers[row]);
+				return DecodeNumber(m.GetValue(),&column.integers[row]);
+			case ColumnBoolean:
+			{
+				if( m.format != FormatJSON )
+				{
+					Value const v	= m.GetValue();
+					if( !v.IsBoolean() )	return false;
+					column.booleans[row]	= v.AsBoolean() ? 1 : 0;
+					return true;
+				}
+				char const* sz	= m.str;
+				size_t len		= m.len;
+				TrimSpan(sz,len);
+				if( len == 4 && memcmp(sz,"true",4) == 0 )	{ column.booleans[row] = 1; return true; }
+				if( len == 5 && memcmp(sz,"false",5) == 0 )	{ column.booleans[row] = 0; return true; }
+				return false;
+			}
+			case ColumnString:
+				return ColumnView(m,column.strings[row]);
+		}
+		return false;
+	}
+
+	bool ExtractColumns(Member const& array,std::vector<Column>& columns,size_t threads)
+	{
+		if( array.type != ARRAY )
+		{
+			return false;
+		}
+		std::vector<std::vector<std::string>> paths(columns.size());
+		for( size_t c=0; c<columns.size(); ++c )
+		{
+			if( !ColumnPath(columns[c].path,paths[c]) )	return false;
+		}
+
+		// Compact arrays only hold scalars, so every row is invalid
+		size_t const rows	= array.Size();
+		bool const objects	= array.values.empty();
+		for( Column& column : columns )
+		{
+			Member::V2 const empty	= { nullptr, 0 };
+			column.rows	= rows;
+			column.doubles.assign(column.type == ColumnDouble ? rows : 0,0.0);
+			column.integers.assign(column.type == ColumnInt64 ? rows : 0,0);
+			column.booleans.assign(column.type == ColumnBoolean ? rows : 0,0);
+			column.strings.assign(column.type == ColumnString ? rows : 0,empty);
+			column.valid.assign((rows + 63) / 64,0);
+		}
+		if( !objects || rows == 0 )
+		{
+			return true;
+		}
+
+		// Key positions along each path in the first object
+		std::vector<std::vector<size_t>> hints(columns.size());
+		Member const* first	= nullptr;
+		for( size_t r=0; r<rows && first==nullptr; ++r )
+		{
+			if( array.members[r].type == OBJECT )	first = &array.members[r];
+		}
+		for( size_t c=0; c<columns.size(); ++c )
+		{
+			Member const* m	= first;
+			for( std::string const& token : paths[c] )
+			{
+				size_t const i	= (m && m->type == OBJECT) ? ColumnKeyIndex(*m,token) : SIZE_MAX;
+				hints[c].push_back(i);
+				m	= i != SIZE_MAX ? &m->members[i+1] : nullptr;
+			}
+		}
+
+		// An exception must not leave a worker (terminate) or skip the joins, so it fails the extraction
+		std::atomic<bool> failed(false);
+		auto Extract	= [&](size_t begin,size_t end)
+		{
+			try
+			{
+				for( size_t r=begin; r<end && !failed; ++r )
+				{
+					for( size_t c=0; c<columns.size(); ++c )
+					{
+						Member const* m	= &array.members[r];
+						for( size_t t=0; t<paths[c].size() && m; ++t )
+						{
+							m	= ColumnField(*m,paths[c][t],hints[c][t]);
+						}
+						if( m && ColumnStore(columns[c],r,*m) )
+						{
+							columns[c].valid[r / 64]	|= (uint64_t)1 << (r % 64);
+						}
+					}
+				}
+			}
+			catch( ... )
+			{
+				failed	= true;
+			}
+		};
+
+		if( threads == 0 )
+		{
+			threads	= std::thread::hardware_concurrency();
+		}
+		// Blocks are whole words of the valid bitmaps, so no two threads write the same word
+		size_t const block	= (((rows + (threads ? threads : 1) - 1) / (threads ? threads : 1)) + 63) / 64 * 64;
+		std::vector<std::thread> workers;
+		workers.reserve(rows / block);
+		for( size_t begin=block; begin<rows; begin+=block )
+		{
+			size_t const end	= begin + block < rows ? begin + block : rows;
+			try
+			{
+				workers.push_back(std::thread(Extract,begin,end));
+			}
+			catch( ... )
+			{
+				// No thread (system_error or bad_alloc), the block runs here instead
+				Extract(begin,end);
+			}
+		}
+		Extract(0,block < rows ? block : rows);
+		for( std::thread& worker : workers )
+		{
+			worker.join();
+		}
+		return !failed;
+	}
+
+	//
+	// Key interning
+	//
+	KeyTable::KeyTable(size_t capacity) : mCapacity(capacity),mCount(0)
+	{
+		size_t slots	= 16;
+		while( slots < capacity * 2 )	slots *= 2;
+		mMask	= slots - 1;
+		mSlots	= new std::atomic<Entry const*>[slots];
+		mById	= new std::atomic<Entry const*>[capacity + 1];
+		for( size_t i=0; i<slots; ++i )		mSlots[i].store(nullptr);
+		for( size_t i=0; i<=capacity; ++i )	mById[i].store(nullptr);
+		mEntries.reserve(capacity);
+	}
+
+	KeyTable::~KeyTable()
+	{
+		delete[] mSlots;
+		delete[] mById;
+	}
+
+	size_t KeyTable::Probe(char const* sz,size_t len,uint64_t hash,Entry const** found) const
+	{
+		size_t i	= hash & mMask;
+		for( ;; )
+		{
+			Entry const* e	= mSlots[i].load(std::memory_order_acquire);
+			if( e == nullptr || (e->hash == hash && e->name.length() == len && memcmp(e->name.data(),sz,len) == 0) )
+			{
+				*found	= e;
+				return i;
+			}
+			i	= (i + 1) & mMask;
+		}
+	}
+
+	KeyId KeyTable::Intern(char const* sz,size_t len)
+	{
+		uint64_t const hash	= HashBytes(sz,len,0);
+		Entry const* found;
+		Probe(sz,len,hash,&found);
+		if( found )	return found->id;
+
+		std::lock_guard<std::mutex> lock(mMutex);
+		// Another thread may have added it since
+		size_t const slot	= Probe(sz,len,hash,&found);
+		if( found )	return found->id;
+		size_t const count	= mCount.load(std::memory_order_relaxed);
+		if( count >= mCapacity )	return KeyNone;
+
+		std::unique_ptr<Entry> entry(new Entry());
+		entry->name.assign(sz,len);
+		entry->hash	= hash;
+		entry->id	= (KeyId)(count + 1);
+		mById[count + 1].store(entry.get(),std::memory_order_release);
+		mSlots[slot].store(entry.get(),std::memory_order_release);
+		mCount.store(count + 1,std::memory_order_release);
+		mEntries.push_back(std::move(entry));
+		return (KeyId)(count + 1);
+	}
+
+	KeyId KeyTable::Lookup(char const* sz,size_t len) const
+	{
+		if( len == 0 )	len = strlen(sz);
+		Entry const* found;
+		Probe(sz,len,HashBytes(sz,len,0),&found);
+		return found ? found->id : KeyNone;
+	}
+
+	std::string const* KeyTable::Name(KeyId id) const
+	{
+		if( id == KeyNone || id > mCapacity )	return nullptr;
+		Entry const* e	= mById[id].load(std::memory_order_acquire);
+		return e ? &e->name : nullptr;
+	}
+
+	inline void InternKey(Member& m,KeyTable& keys,std::string& scratch)
+	{
+		Member::V2 view;
+		if( !ColumnView(m,view) )	return;
+		if( m.format == FormatJSON && memchr(view.str,'\\',view.len) != nullptr )
+		{
+			scratch.clear();
+			if( !UnescapeString(view.str,view.len,scratch) )	return;
+			view.str	= scratch.data();
+			view.len	= scratch.length();
+		}
+		m.key	= keys.Intern(view.str,view.len);
+	}
+
+	// Binary documents are built recursively, so their keys are interned from the finished tree
+	void InternTree(Member& m,KeyTable& keys,std::string& scratch)
+	{
+		if( m.type == KEY )
+		{
+			InternKey(m,keys,scratch);
+		}
+		for( Member& child : m.members )
+		{
+			InternTree(child,keys,scratch);
+		}
+	}
+
+	Member const* Member::Find(KeyId id) const
+	{
+		if( id == KeyNone )	return nullptr;
+		for( size_t i=0; i+1<members.size(); ++i )
+		{
+			if( members[i].key == id && members[i].type == KEY )
+			{
+				return &members[i+1];
+			}
+		}
+		return nullptr;
+	}
+
+	//
+	// Schema validation
+	//
+	inline Schema::Number SchemaNumber(double d)
+	{
+		Schema::Number n;
+		n.value		= d;
+		n.integral	= d == floor(d) && fabs(d) < 18446744073709551616.0;
+		n.negative	= d < 0;
+		n.magnitude	= n.integral ? (uint64_t)fabs(d) : 0;
+		return n;
+	}
+	inline Schema::Number SchemaInteger(bool negative,uint64_t magnitude)
+	{
+		Schema::Number n;
+		n.value		= negative ? -(double)magnitude : (double)magnitude;
+		n.integral	= true;
+		n.negative	= negative && magnitude != 0;
+		n.magnitude	= magnitude;
+		return n;
+	}
+	// Negative, zero or positive as 'a' is below, equal to or above 'b', exactly when both are integers
+	inline int CompareNumbers(Schema::Number const& a,Schema::Number const& b)
+	{
+		if( a.integral && b.integral )
+		{
+			if( a.negative != b.negative )		return a.negative ? -1 : 1;
+			if( a.magnitude == b.magnitude )	return 0;
+			return (a.magnitude < b.magnitude) != a.negative ? -1 : 1;
+		}
+		return a.value < b.value ? -1 : (a.value > b.value ? 1 : 0);
+	}
+	// Reads a number of the schema from its text, so integers are not rounded through a double
+	inline bool SchemaNumberOf(Member const& m,Schema::Number* out)
+	{
+		char const* sz	= m.str;
+		size_t len		= m.len;
+		int64_t i;
+		uint64_t u;
+		if( m.type == VALUE && m.format == FormatJSON && sz != nullptr )
+		{
+			TrimSpan(sz,len);
+			if( ParseInteger(sz,len,&i) )
+			{
+				*out	= SchemaInteger(i < 0,i < 0 ? 0 - (uint64_t)i : (uint64_t)i);
+				return true;
+			}
+			if( ParseUnsigned(sz,len,&u) )
+			{
+				*out	= SchemaInteger(false,u);
+				return true;
+			}
+		}
+		Value const v	= m.GetValue();
+		if( !v.IsNumber() )	return false;
+		*out	= SchemaNumber(v.AsDouble());
+		return true;
+	}
+
+	uint32_t Schema::CompileRule(Member const& m,std::string& error)
+	{
+		uint32_t const index	= (uint32_t)mRules.size();
+		mRules.push_back(Rule());
+		{
+			Rule& r	= mRules.back();
+			r.types				= TypeAny;
+			r.minimum			= SchemaNumber(-HUGE_VAL);
+			r.maximum			= SchemaNumber(HUGE_VAL);
+			r.minimumExclusive	= false;
+			r.maximumExclusive	= false;
+			r.minLength			= 0;
+			r.maxLength			= SIZE_MAX;
+			r.items				= None;
+		}
+
+		if( m.type == VALUE )
+		{
+			// Boolean schemas
+			Value const v	= m.GetValue();
+			if( !v.IsBoolean() )
+			{
+				error	= "a schema must be an object or a boolean";
+				return None;
+			}
+			mRules[index].types	= v.AsBoolean() ? TypeAny : 0;
+			return index;
+		}
+		if( m.type != OBJECT )
+		{
+			error	= "a schema must be an object or a boolean";
+			return None;
+		}
+
+		auto ReadNumber	= [&](Member const& value,char const* keyword,Number* out) -> bool
+		{
+			if( !SchemaNumberOf(value,out) )
+			{
+				error	= std::string(keyword) + " must be a number";
+				return false;
+			}
+			return true;
+		};
+		auto Length	= [&](Member const& value,char const* keyword,size_t* out) -> bool
+		{
+			Number n;
+			if( !ReadNumber(value,keyword,&n) )	return false;
+			if( n.value < 0 || n.value != floor(n.value) )
+			{
+				error	= std::string(keyword) + " must be a non-negative integer";
+				return false;
+			}
+			*out	= !n.integral || n.magnitude > SIZE_MAX ? SIZE_MAX : (size_t)n.magnitude;
+			return true;
+		};
+
+		std::vector<std::string> required;
+		// Bounds are combined after the loop, so the order of the keywords does not matter
+		Number inclusiveMinimum	= SchemaNumber(-HUGE_VAL);
+		Number inclusiveMaximum	= SchemaNumber(HUGE_VAL);
+		Number exclusiveMinimum	= SchemaNumber(-HUGE_VAL);
+		Number exclusiveMaximum	= SchemaNumber(HUGE_VAL);
+		bool minimumFlag		= false;
+		bool maximumFlag		= false;
+		for( size_t i=0; i+1<m.members.size(); i+=2 )
+		{
+			Value const name	= m.members[i].GetValue();
+			Member const& value	= m.members[i+1];
+			std::string const keyword	= name.IsString() ? std::string(name.AsString(),name.len) : std::string();
+			Number n;
+
+			if( keyword == "type" )
+			{
+				uint32_t types	= 0;
+				auto Add	= [&](Member const& t) -> bool
+				{
+					Value const v	= t.GetValue();
+					std::string const n	= v.IsString() ? std::string(v.AsString(),v.len) : std::string();
+					if( n == "null" )			types |= TypeNull;
+					else if( n == "boolean" )	types |= TypeBoolean;
+					else if( n == "integer" )	types |= TypeInteger;
+					else if( n == "number" )	types |= TypeNumber | TypeInteger;
+					else if( n == "string" )	types |= TypeString;
+					else if( n == "array" )		types |= TypeArray;
+					else if( n == "object" )	types |= TypeObject;
+					else
+					{
+						error	= "unknown type \"" + n + "\"";
+						return false;
+					}
+					return true;
+				};
+				if( value.type == ARRAY )
+				{
+					for( size_t t=0; t<value.Size(); ++t )
+					{
+						if( !Add(value.members[t]) )	return None;
+					}
+				}
+				else if( !Add(value) )
+				{
+					return None;
+				}
+				mRules[index].types	= types;
+			}
+			else if( keyword == "minimum" || keyword == "maximum" || keyword == "exclusiveMinimum" || keyword == "exclusiveMaximum" )
+			{
+				bool const minimum		= keyword == "minimum" || keyword == "exclusiveMinimum";
+				bool const exclusive	= keyword[0] == 'e';
+				Value const v			= value.GetValue();
+				if( exclusive && v.IsBoolean() )
+				{
+					// Draft 4 form, a flag on minimum or maximum
+					(minimum ? minimumFlag : maximumFlag)	= v.AsBoolean();
+					continue;
+				}
+				if( !ReadNumber(value,keyword.c_str(),&n) )	return None;
+				(minimum ? (exclusive ? exclusiveMinimum : inclusiveMinimum) : (exclusive ? exclusiveMaximum : inclusiveMaximum))	= n;
+			}
+			else if( keyword == "minLength" )
+			{
+				if( !Length(value,"minLength",&mRules[index].minLength) )	return None;
+			}
+			else if( keyword == "maxLength" )
+			{
+				if( !Length(value,"maxLength",&mRules[index].maxLength) )	return None;
+			}
+			else if( keyword == "items" )
+			{
+				if( value.type == ARRAY )
+				{
+					error	= "items must be a single schema";
+					return None;
+				}
+				uint32_t const items	= CompileRule(value,error);
+				if( items == None )	return None;
+				mRules[index].items	= items;
+			}
+			else if( keyword == "properties" )
+			{
+				if( value.type != OBJECT )
+				{
+					error	= "properties must be an object";
+					return None;
+				}
+				for( size_t p=0; p+1<value.members.size(); p+=2 )
+				{
+					Value const n	= value.members[p].GetValue();
+					uint32_t const rule	= CompileRule(value.members[p+1],error);
+					if( rule == None )	return None;
+					Property property;
+					property.name.assign(n.AsString(),n.len);
+					property.rule		= rule;
+					property.required	= false;
+					mRules[index].properties.push_back(property);
+				}
+			}
+			else if( keyword == "required" )
+			{
+				if( value.type != ARRAY )
+				{
+					error	= "required must be an array of strings";
+					return None;
+				}
+				for( size_t r=0; r<value.Size(); ++r )
+				{
+					Value const n	= value.members[r].GetValue();
+					if( !n.IsString() )
+					{
+						error	= "required must be an array of strings";
+						return None;
+					}
+					required.push_back(std::string(n.AsString(),n.len));
+				}
+			}
+			else if( keyword == "enum" )
+			{
+				if( value.type != ARRAY )
+				{
+					error	= "enum must be an array";
+					return None;
+				}
+				for( size_t e=0; e<value.Size(); ++e )
+				{
+					Member const& item	= value.members[e];
+					Value const v		= item.GetValue();
+					if( item.type != VALUE || v.GetType() == ValueError )
+					{
+						error	= "enum values must be scalars";
+						return None;
+					}
+					Constant c;
+					c.number	= SchemaNumber(0);
+					c.boolean	= false;
+					switch( v.GetType() )
+					{
+						case ValueNull:		c.type = TypeNull; break;
+						case ValueBoolean:	c.type = TypeBoolean; c.boolean = v.AsBoolean(); break;
+						case ValueNumber:	c.type = TypeNumber; SchemaNumberOf(item,&c.number); break;
+						default:			c.type = TypeString; c.string.assign(v.AsString(),v.len); break;
+					}
+					mRules[index].enumeration.push_back(c);
+				}
+			}
+		}
+
+		{
+			// The stricter bound wins when both forms are given
+			Rule& r	= mRules[index];
+			r.minimum			= inclusiveMinimum;
+			r.minimumExclusive	= minimumFlag;
+			if( CompareNumbers(exclusiveMinimum,r.minimum) >= 0 )
+			{
+				r.minimum			= exclusiveMinimum;
+				r.minimumExclusive	= true;
+			}
+			r.maximum			= inclusiveMaximum;
+			r.maximumExclusive	= maximumFlag;
+			if( CompareNumbers(exclusiveMaximum,r.maximum) <= 0 )
+			{
+				r.maximum			= exclusiveMaximum;
+				r.maximumExclusive	= true;
+			}
+		}
+
+		std::vector<Property>& properties	= mRules[index].properties;
+		for( std::string const& name : required )
+		{
+			bool found	= false;
+			for( Property& property : properties )
+			{
+				if( property.name == name )
+				{
+					property.required	= true;
+					found	= true;
+				}
+			}
+			if( !found )
+			{
+				Property property;
+				property.name		= name;
+				property.rule		= None;
+				property.required	= true;
+				properties.push_back(property);
+			}
+		}
+		std::sort(properties.begin(),properties.end(),[](Property const& a,Property const& b) { return a.name < b.name; });
+		return index;
+	}
+
+	bool Schema::Compile(char const* json,size_t len,std::string* error)
+	{
+		std::string message;
+		std::string const text(json,len);
+		Member root(text.c_str(),text.length());
+		mRules.clear();
+		size_t const start	= TrimLeft(text.c_str(),text.length());
+		if( start < text.length() && text[start] != '{' && text[start] != '[' )
+		{
+			// Boolean schemas are a bare scalar, which Parse does not take as a root
+			root.type	= VALUE;
+			if( CompileRule(root,message) == None )
+			{
+				mRules.clear();
+			}
+		}
+		else if( !Parse(root) )
+		{
+			message	= "the schema is not valid JSON";
+		}
+		else if( CompileRule(root,message) == None )
+		{
+			mRules.clear();
+		}
+		if( error )	*error = message;
+		return Compiled();
+	}
+
+	void SchemaValidator::Reset()
+	{
+		mDepth	= 0;
+		mSeen.clear();
+		mError.clear();
+	}
+
+	bool SchemaValidator::Fail(std::string const& message)
+	{
+		mError.clear();
+		for( size_t i=0; i<mDepth; ++i )
+		{
+			Frame const& f	= mStack[i];
+			if( !f.object )
+			{
+				mError	+= '/';
+				mError	+= std::to_string(f.index > 0 ? f.index - 1 : 0);
+				continue;
+			}
+			mError	+= '/';
+			for( char ch : f.key )
+			{
+				if( ch == '~' )			mError += "~0";
+				else if( ch == '/' )	mError += "~1";
+				else					mError += ch;
+			}
+		}
+		mError	+= ": ";
+		mError	+= message;
+		return false;
+	}
+
+	// Rule of the value that starts now
+	uint32_t SchemaValidator::Begin()
+	{
+		if( mDepth == 0 )
+		{
+			return mSchema.Compiled() ? 0 : Schema::None;
+		}
+		Frame& f	= mStack[mDepth-1];
+		if( !f.object )
+		{
+			f.index++;
+		}
+		return f.next;
+	}
+
+	bool SchemaValidator::Check(uint32_t rule,uint32_t type)
+	{
+		if( rule == Schema::None )	return true;
+		Schema::Rule const& r	= mSchema.GetRule(rule);
+		if( (r.types & type) == 0 )
+		{
+			return Fail(r.types == 0 ? "no value is allowed" : "wrong type");
+		}
+		if( !r.enumeration.empty() && (type & (Schema::TypeArray | Schema::TypeObject)) )
+		{
+			return Fail("not one of the enum values");
+		}
+		return true;
+	}
+
+	bool SchemaValidator::CheckConstant(uint32_t rule,Schema::Constant const& value)
+	{
+		if( rule == Schema::None )	return true;
+		std::vector<Schema::Constant> const& enumeration	= mSchema.GetRule(rule).enumeration;
+		if( enumeration.empty() )	return true;
+		for( Schema::Constant const& c : enumeration )
+		{
+			if( c.type != value.type )	continue;
+			if( c.type == Schema::TypeNull
+				|| (c.type == Schema::TypeBoolean && c.boolean == value.boolean)
+				|| (c.type == Schema::TypeNumber && CompareNumbers(c.number,value.number) == 0)
+				|| (c.type == Schema::TypeString && c.string == value.string) )
+			{
+				return true;
+			}
+		}
+		return Fail("not one of the enum values");
+	}
+
+	bool SchemaValidator::OnNull()
+	{
+		uint32_t const rule	= Begin();
+		if( rule == Schema::None )	return true;
+		Schema::Constant c;
+		c.type	= Schema::TypeNull;
+		return Check(rule,Schema::TypeNull) && CheckConstant(rule,c);
+	}
+
+	bool SchemaValidator::OnBoolean(bool value)
+	{
+		uint32_t const rule	= Begin();
+		if( rule == Schema::None )	return true;
+		Schema::Constant c;
+		c.type		= Schema::TypeBoolean;
+		c.boolean	= value;
+		return Check(rule,Schema::TypeBoolean) && CheckConstant(rule,c);
+	}
+
+	bool SchemaValidator::CheckNumber(Schema::Number const& value)
+	{
+		uint32_t const rule	= Begin();
+		if( rule == Schema::None )	return true;
+		bool const integer	= value.integral || (value.value == floor(value.value) && fabs(value.value) < HUGE_VAL);
+		if( !Check(rule,integer ? Schema::TypeInteger : Schema::TypeNumber) )	return false;
+		Schema::Rule const& r	= mSchema.GetRule(rule);
+		int const minimum	= CompareNumbers(value,r.minimum);
+		int const maximum	= CompareNumbers(value,r.maximum);
+		if( minimum < 0 || (r.minimumExclusive && minimum == 0) )	return Fail("below minimum");
+		if( maximum > 0 || (r.maximumExclusive && maximum == 0) )	return Fail("above maximum");
+		Schema::Constant c;
+		c.type		= Schema::TypeNumber;
+		c.number	= value;
+		return CheckConstant(rule,c);
+	}
+
+	bool SchemaValidator::OnNumber(double value)
+	{
+		return CheckNumber(SchemaNumber(value));
+	}
+
+	bool SchemaValidator::OnInteger(int64_t value)
+	{
+		return CheckNumber(SchemaInteger(value < 0,value < 0 ? 0 - (uint64_t)value : (uint64_t)value));
+	}
+
+	bool SchemaValidator::OnUnsigned(uint64_t value)
+	{
+		return CheckNumber(SchemaInteger(false,value));
+	}
+
+	bool SchemaValidator::OnString(char const* sz,size_t len)
+	{
+		uint32_t const rule	= Begin();
+		if( rule == Schema::None )	return true;
+		if( !Check(rule,Schema::TypeString) )	return false;
+		Schema::Rule const& r	= mSchema.GetRule(rule);
+		if( r.minLength > 0 || r.maxLength != SIZE_MAX )
+		{
+			// Lengths are in code points, so UTF-8 continuation bytes are not counted
+			size_t points	= 0;
+			for( size_t i=0; i<len; ++i )
+			{
+				if( ((uint8_t)sz[i] & 0xc0) != 0x80 )	++points;
+			}
+			if( points < r.minLength )	return Fail("shorter than minLength");
+			if( points > r.maxLength )	return Fail("longer than maxLength");
+		}
+		if( r.enumeration.empty() )	return true;
+		Schema::Constant c;
+		c.type	= Schema::TypeString;
+		c.string.assign(sz,len);
+		return CheckConstant(rule,c);
+	}
+
+	bool SchemaValidator::OnKey(char const* sz,size_t len)
+	{
+		if( mDepth == 0 || !mStack[mDepth-1].object )
+		{
+			return Fail("key outside an object");
+		}
+		Frame& f	= mStack[mDepth-1];
+		f.key.assign(sz,len);
+		f.next	= Schema::None;
+		if( f.rule == Schema::None )	return true;
+
+		std::vector<Schema::Property> const& properties	= mSchema.GetRule(f.rule).properties;
+		size_t lo	= 0;
+		size_t hi	= properties.size();
+		while( lo < hi )
+		{
+			size_t const mid	= (lo + hi) / 2;
+			int const order		= properties[mid].name.compare(0,std::string::npos,sz,len);
+			if( order == 0 )
+			{
+				f.next	= properties[mid].rule;
+				mSeen[f.seen + mid / 64]	|= (uint64_t)1 << (mid % 64);
+				break;
+			}
+			if( order < 0 )	lo = mid + 1;
+			else			hi = mid;
+		}
+		return true;
+	}
+
+	bool SchemaValidator::OnStartObject()
+	{
+		uint32_t const rule	= Begin();
+		if( !Check(rule,Schema::TypeObject) )	return false;
+		if( mDepth == mStack.size() )	mStack.push_back(Frame());
+		Frame& f	= mStack[mDepth++];
+		f.rule		= rule;
+		f.next		= Schema::None;
+		f.object	= true;
+		f.index		= 0;
+		f.seen		= mSeen.size();
+		f.key.clear();
+		if( rule != Schema::None )
+		{
+			mSeen.resize(f.seen + (mSchema.GetRule(rule).properties.size() + 63) / 64,0);
+		}
+		return true;
+	}
+
+	bool SchemaValidator::OnEndObject()
+	{
+		if( mDepth == 0 || !mStack[mDepth-1].object )
+		{
+			return Fail("unbalanced end of object");
+		}
+		Frame& f	= mStack[mDepth-1];
+		if( f.rule != Schema::None )
+		{
+			std::vector<Schema::Property> const& properties	= mSchema.GetRule(f.rule).properties;
+			for( size_t i=0; i<properties.size(); ++i )
+			{
+				if( properties[i].required && ((mSeen[f.seen + i / 64] >> (i % 64)) & 1) == 0 )
+				{
+					// Reported at the path of the object itself
+					--mDepth;
+					return Fail("missing required property \"" + properties[i].name + "\"");
+				}
+			}
+			mSeen.resize(f.seen);
+		}
+		--mDepth;
+		return true;
+	}
+
+	bool SchemaValidator::OnStartArray()
+	{
+		uint32_t const rule	= Begin();
+		if( !Check(rule,Schema::TypeArray) )	return false;
+		if( mDepth == mStack.size() )	mStack.push_back(Frame());
+		Frame& f	= mStack[mDepth++];
+		f.rule		= rule;
+		f.next		= rule != Schema::None ? mSchema.GetRule(rule).items : Schema::None;
+		f.object	= false;
+		f.index		= 0;
+		f.seen		= mSeen.size();
+		return true;
+	}
+
+	bool SchemaValidator::OnEndArray()
+	{
+		if( mDepth == 0 || mStack[mDepth-1].object )
+		{
+			return Fail("unbalanced end of array");
+		}
+		--mDepth;
+		return true;
+	}
+
+	// Passes a JSON scalar to the validator, decoding it without allocating unless it has escapes
+	inline bool ValidateScalar(char const* sz,size_t len,SchemaValidator& validator,std::string& scratch)
+	{
+		TrimSpan(sz,len);
+		if( len == 0 )	return false;
+		if( sz[0] == '\"' )
+		{
+			if( len < 2 || sz[len-1] != '\"' )	return false;
+			if( memchr(sz + 1,'\\',len - 2) == nullptr )
+			{
+				return validator.OnString(sz + 1,len - 2);
+			}
+			scratch.clear();
+			return UnescapeString(sz + 1,len - 2,scratch) && validator.OnString(scratch.data(),scratch.length());
+		}
+		int64_t i;
+		uint64_t u;
+		double d;
+		if( len == 4 && memcmp(sz,"true",4) == 0 )		return validator.OnBoolean(true);
+		if( len == 5 && memcmp(sz,"false",5) == 0 )		return validator.OnBoolean(false);
+		if( len == 4 && memcmp(sz,"null",4) == 0 )		return validator.OnNull();
+		if( ParseInteger(sz,len,&i) )					return validator.OnInteger(i);
+		if( ParseUnsigned(sz,len,&u) )					return validator.OnUnsigned(u);
+		if( ParseDouble(sz,len,&d) )					return validator.OnNumber(d);
+		return false;
+	}
+
+	// Called as Parse completes each member, whose children have already been passed on
+	inline bool ValidateMember(Member const& m,SchemaValidator& validator,std::string& scratch)
+	{
+		switch( m.type )
+		{
+			case OBJECT:	return validator.OnEndObject();
+			case ARRAY:		return validator.OnEndArray();
+			case KEY:
+			{
+				Member::V2 view;
+				if( !ColumnView(m,view) )	return false;
+				if( memchr(view.str,'\\',view.len) == nullptr )
+				{
+					return validator.OnKey(view.str,view.len);
+				}
+				scratch.clear();
+				return UnescapeString(view.str,view.len,scratch) && validator.OnKey(scratch.data(),scratch.length());
+			}
+			case VALUE:
+				// Whitespace only is the placeholder element of an empty array
+				if( TrimLeft(m.str,m.len) >= m.len )	return true;
+				return ValidateScalar(m.str,m.len,validator,scratch);
+		}
+		return false;
+	}
+
+	// Binary documents are built recursively, so they are validated from the finished tree
+	bool ValidateTree(Member const& m,SchemaValidator& validator,std::string& scratch)
+	{
+		Member::V2 view;
+		switch( m.type )
+		{
+			case OBJECT:
+				if( !validator.OnStartObject() )	return false;
+				for( size_t i=0; i+1<m.members.size(); i+=2 )
+				{
+					if( !ColumnView(m.members[i],view) || !validator.OnKey(view.str,view.len) )	return false;
+					if( !ValidateTree(m.members[i+1],validator,scratch) )	return false;
+				}
+				return validator.OnEndObject();
+			case ARRAY:
+				if( !validator.OnStartArray() )	return false;
+				for( Member const& child : m.members )
+				{
+					if( !ValidateTree(child,validator,scratch) )	return false;
+				}
+				return validator.OnEndArray();
+			default:
+			{
+				if( ColumnView(m,view) )	return validator.OnString(view.str,view.len);
+				BinaryHeader h;
+				if( ReadBinaryHeader(m.str,m.len,m.format,h) )
+				{
+					if( h.kind == BinaryInt )	return validator.OnInteger(h.i);
+					if( h.kind == BinaryUInt )	return validator.OnUnsigned(h.u);
+				}
+				Value const v	= m.GetValue();
+				switch( v.GetType() )
+				{
+					case ValueNull:		return validator.OnNull();
+					case ValueBoolean:	return validator.OnBoolean(v.AsBoolean());
+					case ValueNumber:	return validator.OnNumber(v.AsDouble());
+					default:			return false;
+				}
+			}
+		}
+	}
+
+	Member const* Member::Find(char const* sz,size_t szLen) const
+	{
+		if( szLen==0 )	szLen	= strlen(sz);
+		for( size_t i=0; i<members.size(); ++i )
+		{
+			Member const& m	= members[i];
+			if( m.type==KEY )
+			{
+				Value v	= m.GetValue();
+				if( szLen==v.len && szLen>0 && strncmp(v.AsString(),sz,szLen)==0 )
+				{
+					return (i<members.size()-1)? &members[i+1] : nullptr;
+				}
+			}
+		}
+		return nullptr;
+	}
+	Member const* Member::FindRecursive(char const* sz,size_t szLen) const
+	{
+		if( szLen==0 )	szLen	= strlen(sz);
+		for( size_t i=0; i<members.size(); ++i )
+		{
+			Member const& m	= members[i];
+			if( m.type==KEY )
+			{
+				Value v	= m.GetValue();
+				if( szLen==v.len && szLen>0 && strncmp(v.AsString(),sz,szLen)==0 )
+				{
+					return (i<members.size()-1)? &members[i+1] : nullptr;
+				}
+			}
+			else
+			{
+				Member const* p = m.Find(sz,szLen);
+				if( p != nullptr )	return p;
+			}
+		}
+		return nullptr;
+	}
+
+#ifdef JSONIC_STATS
+	inline uint64_t StatsNow()
+	{
+		return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+	inline void StatsAllocated(ParseStats* stats,size_t before,size_t after,size_t size)
+	{
+		if( after != before )
+		{
+			stats->allocations++;
+			stats->allocatedBytes	+= after * size;
+			if( stats->onAllocate )
+			{
+				stats->onAllocate(after * size);
+			}
+		}
+	}
+	// Binary documents are built recursively, so their counts are gathered from the finished tree
+	void StatsCount(Member const& m,ParseStats* stats,size_t depth)
+	{
+		if( m.type == OBJECT )		stats->objects++;
+		else if( m.type == ARRAY )	stats->arrays++;
+		else if( m.type == KEY )	stats->keys++;
+		else						stats->values++;
+		if( depth > stats->maxDepth )	stats->maxDepth = depth;
+		for( Member const& child : m.members )
+		{
+			StatsCount(child,stats,depth + 1);
+		}
+	}
+	void StatsDecode(Member const& m)
+	{
+		if( m.type == KEY || m.type == VALUE )
+		{
+			Value v	= m.GetValue();
+			(void)v;
+		}
+		for( size_t i=0; i<m.values.size(); ++i )
+		{
+			Value v	= m.GetValue(i);
+			(void)v;
+		}
+		for( Member const& child : m.members )
+		{
+			StatsDecode(child);
+		}
+	}
+#endif
+
+	// 'stats' is only read when JSONIC_STATS is defined
+	bool ParseMembers(Member& root,int flags,KeyTable* keys,SchemaValidator* validator,ParseStats* stats);
+
+	bool Parse(Member& root)
+	{
+		return ParseMembers(root,ParseDefault,nullptr,nullptr,nullptr);
+	}
+	bool Parse(Member& root,int flags)
+	{
+		return ParseMembers(root,flags,nullptr,nullptr,nullptr);
+	}
+#ifdef JSONIC_STATS
+	bool Parse(Member& root,ParseStats* stats)
+	{
+		return ParseMembers(root,ParseDefault,nullptr,nullptr,stats);
+	}
+	bool Parse(Member& root,int flags,ParseStats* stats)
+	{
+		return ParseMembers(root,flags,nullptr,nullptr,stats);
+	}
+#endif
+	bool Parse(Member& root,KeyTable& keys,int flags)
+	{
+		return ParseMembers(root,flags,&keys,nullptr,nullptr);
+	}
+	bool Parse(Member& root,SchemaValidator& validator,int flags)
+	{
+		return ParseMembers(root,flags,nullptr,&validator,nullptr);
+	}
+
+	bool ParseMembers(Member& root,int flags,KeyTable* keys,SchemaValidator* validator,ParseStats* stats)
+	{
+		static const char BlockBegin	= '{';
+		static const char BlockEnd		= '}';
+		static const char ArrayBegin	= '[';
+		static const char ArrayEnd		= ']';
+		static const char Separator		= ',';
+		static const char ValueBegin	= ':';
+		static const char Quote			= '\"';
+
+		(void)stats;
+		JSONIC_STAT( bool const timing	= stats && stats->timePhases; )
+		JSONIC_STAT( uint64_t phaseStart	= timing ? StatsNow() : 0; )
+		JSONIC_STAT( uint64_t scanTime	= 0; )
+		JSONIC_STAT( uint64_t buildTime	= 0; )
+		// Each phase boundary reads the clock once, which ends one phase and starts the next
+		JSONIC_STAT(
+		auto EndPhase	= [&](uint64_t& phaseTime)
+		{
+			uint64_t const now	= StatsNow();
+			phaseTime	+= now - phaseStart;
+			phaseStart	= now;
+		};
+		)
+
+		bool const hashing	= (flags & ParseHash) != 0;
+		std::string scratch;
+		if( validator )
+		{
+			validator->Reset();
+		}
+
+		if( root.format != FormatJSON )
+		{
+			bool ok	= ParseBinary(root);
+			if( ok && validator )
+			{
+				ok	= ValidateTree(root,*validator,scratch);
+			}
+			if( ok && hashing )
+			{
+				HashTree(root,scratch);
+			}
+			if( ok && keys )
+			{
+				InternTree(root,*keys,scratch);
+			}
+			JSONIC_STAT(
+			if( stats )
+			{
+				stats->bytesScanned	+= root.len;
+				if( ok )					StatsCount(root,stats,0);
+				if( timing )				stats->buildTime += StatsNow() - phaseStart;
+				if( ok && stats->decodeValues )
+				{
+					uint64_t const decodeStart	= StatsNow();
+					StatsDecode(root);
+					stats->decodeTime	+= StatsNow() - decodeStart;
+				}
+			}
+			)
+			return ok;
+		}
+		if( root.str == nullptr || root.len < 2 )
+		{
+			return false;
+		}
+
+		Member* pv		= &root;
+		pv->type		= VALUE;
+		char const* psz	= pv->str;
+
+		std::vector<Member*>	stack;
+		// Pseudo push the first brace (don't call PushVar, since it's not being added to a parent)
+		stack.push_back(pv);
+		JSONIC_STAT( if( stats ) StatsAllocated(stats,0,stack.capacity(),sizeof(Member*)); )
+
+		std::function<void(MemberType)> PushVar	= [&](MemberType type)
+		{
+			JSONIC_STAT( if( timing ) EndPhase(scanTime); )
+			JSONIC_STAT( size_t const stackCapacity	= stack.capacity(); )
+			JSONIC_STAT( size_t const memberCapacity	= pv->members.capacity(); )
+			stack.push_back(pv);
+			pv->members.push_back(Member());
+			JSONIC_STAT(
+			if( stats )
+			{
+				StatsAllocated(stats,stackCapacity,stack.capacity(),sizeof(Member*));
+				StatsAllocated(stats,memberCapacity,pv->members.capacity(),sizeof(Member));
+				if( stack.size() - 1 > stats->maxDepth )	stats->maxDepth = stack.size() - 1;
+			}
+			)
+
+			pv	= &pv->members.back();
+			pv->type	= type;
+			// psz points to delimiter
+			pv->str		= psz + 1;
+			pv->len		= 0;
+			JSONIC_STAT( if( timing ) EndPhase(buildTime); )
+		};
+
+		std::function<bool()> PopVar	= [&]()
+		{
+			JSONIC_STAT(
+			if( stats )
+			{
+				if( pv->type == OBJECT )		stats->objects++;
+				else if( pv->type == ARRAY )	stats->arrays++;
+				else if( pv->type == KEY )		stats->keys++;
+				else							stats->values++;
+			}
+			)
+			// psz should be a delimiter, so don't include it in len
+			// the exception is quotes, see Quote section in loop
+			pv->len	= psz - pv->str;
+			if( hashing )
+			{
+				// Children are complete, so only this level is combined
+				HashMember(*pv,scratch);
+			}
+			if( stack.size()==0 )
+			{
+				return false;
+			}
+			// Only once the member is known to be open, an extra closing bracket has nothing to end
+			if( validator && !ValidateMember(*pv,*validator,scratch) )
+			{
+				return false;
+			}
+			pv	= stack.back();
+			stack.pop_back();
+			return true;
+		};
+
+		// With ParseCompactArrays an array records its elements as spans while it has no members
+		// and is promoted to members when an object or array element turns up
+		bool const compact	= (flags & ParseCompactArrays) != 0;
+		char const* element	= nullptr;	// start of the current element of a compact array
+
+		auto InCompact	= [&]() -> bool
+		{
+			return compact && pv->type==ARRAY && pv->members.empty();
+		};
+		auto AddSpan	= [&](bool last) -> bool
+		{
+			size_t const n	= psz - element;
+			// The final span of an empty array is only whitespace
+			if( !last || TrimLeft(element,n) < n )
+			{
+				Member::V2 const v	= { element, n };
+				pv->values.push_back(v);
+				JSONIC_STAT( if( stats ) stats->values++; )
+				if( validator )
+				{
+					return ValidateScalar(element,n,*validator,scratch);
+				}
+			}
+			return true;
+		};
+		auto Promote	= [&]()
+		{
+			pv->members.reserve(pv->values.size() + 1);
+			for( Member::V2 const& v : pv->values )
+			{
+				pv->members.push_back(Member(v.str,v.len));
+				pv->members.back().type	= VALUE;
+				if( hashing )
+				{
+					HashMember(pv->members.back(),scratch);
+				}
+			}
+			pv->values.clear();
+			PushVar(VALUE);
+			pv->str	= element;
+		};
+
+		// The scan returns early on a syntax error, so statistics are finished after it
+		auto Scan	= [&]() -> bool
+		{
+			while( *psz != '\0' )
+			{
+				if( *psz == Quote )
+				{
+					if( pv->type == OBJECT )
+					{
+						// We need to keep quotes, but discard every other delimiter
+						--psz; PushVar(KEY); ++psz;
+					}
+					else if( pv->type != VALUE && !InCompact() )
+					{
+						return false;
+					}
+
+					JSONIC_STAT( char const* quoted	= psz; )
+					do
+					{
+						++psz;
+					}while( *psz!='\0' && (*psz!=Quote || *(psz-1)=='\\') );
+					if( *psz == '\0' )	return false;	// unterminated string
+					JSONIC_STAT( if( stats && memchr(quoted + 1,'\\',psz - quoted - 1) ) stats->escapedStrings++; )
+
+					if( pv->type == KEY )
+					{
+						++psz;
+						if( !PopVar() )	return false;
+						--psz;
+						if( keys )
+						{
+							Member& key	= pv->members.back();
+							InternKey(key,*keys,scratch);
+						}
+					}
+				}
+				else if( *psz == BlockBegin )
+				{
+					if( InCompact() )
+					{
+						Promote();
+					}
+					if( pv->type==VALUE )
+					{
+						pv->type	= OBJECT;
+					}
+					else
+					{
+						PushVar(OBJECT);
+					}
+					if( validator && !validator->OnStartObject() )	return false;
+				}
+				else if( *psz == ValueBegin )
+				{
+					if( pv->type != OBJECT )	return false;
+					PushVar(VALUE);
+				}
+				else if( *psz == ArrayBegin )
+				{
+					if( InCompact() )
+					{
+						Promote();
+					}
+					if( pv->type != VALUE )	return false;
+					pv->type	= ARRAY;
+					if( validator && !validator->OnStartArray() )	return false;
+					if( compact )
+					{
+						element	= psz + 1;
+					}
+					else
+					{
+						PushVar(VALUE);
+					}
+				}
+				else if( *psz == Separator && InCompact() )
+				{
+					if( !AddSpan(false) )	return false;
+					element	= psz + 1;
+				}
+				else if( *psz == Separator )
+				{
+					if( pv->type == VALUE )
+					{
+						if( !PopVar() )	return false;
+					}
+					if( pv->type==ARRAY )
+					{
+						PushVar(VALUE);
+					}
+				}
+				else if( *psz == ArrayEnd && InCompact() )
+				{
+					if( !AddSpan(true) )	return false;
+					if( !PopVar() )	return false;
+				}
+				else if( *psz == ArrayEnd )
+				{
+					if( pv->type == VALUE )
+					{
+						if( !PopVar() )	return false;
+					}
+
+					if( !PopVar() )	return false;
+				}
+				else if( *psz == BlockEnd )
+				{
+					if( pv->type == VALUE )
+					{
+						if( !PopVar() )	return false;
+					}
+
+					if( !PopVar() )	return false;
+				}
+				++psz;
+			}
+			return stack.size()==0;
+		};
+
+		bool const ok	= Scan();
+		JSONIC_STAT(
+		if( stats )
 		{
-			case 0x0009:
-			case 0x000A:
-			case 0x000B:
-			case 0x000C:
-			case 0x000D:
-			case 0x0020:
-			case 0x0085:
-			//case 0x00A0:
-			case 0x1680:
-			case 0x2000:
-			case 0x2001:
-			case 0x2002:
-			case 0x2003:
-			case 0x2004:
-			case 0x2005:
-			case 0x2006:
-			//case 0x2007:
-			case 0x2008:
-			case 0x2009:
-			case 0x200A:
-			case 0x2028:
-			case 0x2029:
-			//case 0x202F:
-			case 0x205F:
-			//case 0x2060:
-			case 0x3000:
-			//case 0xFEFF:
-				return true;
-		};
-		return false;
-	}
-	inline bool IsLineBreak(uint32_t code)
-	{
-		return code == 0x0A || code == 0x85;
+			stats->bytesScanned	+= psz - root.str;
+			if( timing )
+			{
+				EndPhase(scanTime);
+				stats->scanTime		+= scanTime;
+				stats->buildTime	+= buildTime;
+			}
+			if( ok && stats->decodeValues )
+			{
+				uint64_t const decodeStart	= StatsNow();
+				StatsDecode(root);
+				stats->decodeTime	+= StatsNow() - decodeStart;
+			}
+		}
+		)
+		return ok;
 	}
 
-
-	inline bool IsWhiteSpace(char ch)
-	{
-		return IsWhiteSpace((uint32_t)ch);
-	}
-	inline bool IsWhiteSpace(wchar_t ch)
-	{
-		return IsWhiteSpace((uint32_t)ch);
-	}
-	inline bool IsWhiteSpace(char const* str)
+	//
+	// Fixed capacity parsing
+	//
+	inline char const* ScanNumber(char const* p,char const* end)
 	{
-		uint32_t code;
-		UTF8toUTF32Char(str, &code);
-		return IsWhiteSpace(code);
+		auto Digits	= [&]() -> bool
+		{
+			char const* begin	= p;
+			while( p<end && *p>='0' && *p<='9' )	++p;
+			return p > begin;
+		};
+		if( p<end && *p=='-' )	++p;
+		char const* first	= p;
+		if( !Digits() || IsLeadingZero(first,p - first) )	return nullptr;
+		if( p<end && *p=='.' )
+		{
+			++p;
+			if( !Digits() )	return nullptr;
+		}
+		if( p<end && (*p=='e' || *p=='E') )
+		{
+			++p;
+			if( p<end && (*p=='-' || *p=='+') )	++p;
+			if( !Digits() )	return nullptr;
+		}
+		return p;
 	}
 
-	template<class T>
-	inline int TStringCmp(T const* szA,T const* szB)
+	bool Parse(char const* src,size_t len,NodeSpan nodes,DepthSpan depth,size_t* count) noexcept
 	{
-		while(*szA != 0)
+		if( count )	*count = 0;
+		if( src == nullptr || nodes.data == nullptr )
 		{
-			if(*szB == 0)	return  1;
-			if(*szB > *szA)	return -1;
-			if(*szA > *szB)	return  1;
-
-			szA++;
-			szB++;
+			return false;
 		}
+		size_t const capacity	= nodes.size < UINT32_MAX ? nodes.size : UINT32_MAX;
+		size_t used			= 0;	// nodes written
+		size_t open			= 0;	// entries of the depth stack in use
+		char const* psz		= src;
+		char const* end		= src + len;
 
-		if(*szB != 0)	return -1;
-		return 0;
-	}
+		auto SkipSpace	= [&]()
+		{
+			while( psz<end && (*psz==' ' || *psz=='\n' || *psz=='\r' || *psz=='\t') )
+			{
+				++psz;
+			}
+		};
+		auto Add	= [&](MemberType type) -> Node*
+		{
+			if( used >= capacity )	return nullptr;
+			if( open > 0 && (type == KEY || nodes.data[depth.data[open-1]].type == ARRAY) )
+			{
+				nodes.data[depth.data[open-1]].count++;
+			}
+			Node* n		= &nodes.data[used++];
+			n->type		= type;
+			n->count	= 0;
+			n->size		= 1;
+			n->str		= psz;
+			n->len		= 0;
+			return n;
+		};
+		// psz is on the opening quote and is left after the closing quote
+		auto ReadString	= [&](Node* n) -> bool
+		{
+			++psz;
+			while( psz<end && *psz!='\"' )
+			{
+				if( *psz=='\\' && ++psz == end )	return false;
+				++psz;
+			}
+			if( psz >= end )	return false;
+			n->len	= ++psz - n->str;
+			return true;
+		};
+		auto Open	= [&](MemberType type) -> bool
+		{
+			if( open >= depth.size || Add(type) == nullptr )	return false;
+			depth.data[open++]	= (uint32_t)(used - 1);
+			++psz;
+			return true;
+		};
+		auto Close	= [&]()
+		{
+			Node& n	= nodes.data[depth.data[--open]];
+			n.size	= (uint32_t)(used - depth.data[open]);
+			n.len	= ++psz - n.str;
+		};
 
+		// Expecting a value, a key, or what follows a complete value
+		enum { StateValue, StateKey, StateNext } state	= StateValue;
+		for( ;; )
+		{
+			SkipSpace();
+			if( state == StateNext )
+			{
+				if( open == 0 )
+				{
+					if( psz != end && *psz != '\0' )	return false;
+					if( count )	*count = used;
+					return true;
+				}
+				if( psz >= end )	return false;
+				MemberType const parent	= nodes.data[depth.data[open-1]].type;
+				if( *psz == ',' )
+				{
+					++psz;
+					state	= parent==OBJECT ? StateKey : StateValue;
+				}
+				else if( (*psz == '}' && parent==OBJECT) || (*psz == ']' && parent==ARRAY) )
+				{
+					Close();
+				}
+				else
+				{
+					return false;
+				}
+				continue;
+			}
+			if( psz >= end )	return false;
 
+			if( state == StateKey )
+			{
+				Node* key	= Add(KEY);
+				if( key == nullptr || *psz!='\"' || !ReadString(key) )	return false;
+				SkipSpace();
+				if( psz>=end || *psz!=':' )	return false;
+				++psz;
+				state	= StateValue;
+				continue;
+			}
 
-	//
-	//
-	//
-	inline bool IsAscii(char ch)
-	{
-		return ((uint8_t)ch & 0x80) == 0;
+			char const ch	= *psz;
+			state	= StateNext;
+			if( ch == '{' || ch == '[' )
+			{
+				if( !Open(ch == '{' ? OBJECT : ARRAY) )	return false;
+				SkipSpace();
+				if( psz<end && *psz==(ch == '{' ? '}' : ']') )
+				{
+					Close();
+					continue;
+				}
+				state	= ch == '{' ? StateKey : StateValue;
+				continue;
+			}
+
+			Node* value	= Add(VALUE);
+			if( value == nullptr )	return false;
+			if( ch == '\"' )
+			{
+				if( !ReadString(value) )	return false;
+				continue;
+			}
+			if( end-psz>=4 && strncmp(psz,"true",4)==0 )		psz += 4;
+			else if( end-psz>=5 && strncmp(psz,"false",5)==0 )	psz += 5;
+			else if( end-psz>=4 && strncmp(psz,"null",4)==0 )	psz += 4;
+			else if( (psz = ScanNumber(psz,end)) == nullptr )	return false;
+			value->len	= psz - value->str;
+		}
 	}
-	inline bool IsUTF8(char ch)
+
+	Value Node::GetValue() const
 	{
-		return ((uint8_t)ch & 0xc0) != 0x80;
+		Member m(str,len);
+		m.type	= type;
+		return m.GetValue();
 	}
-	inline bool IsTrailingUTF8(char ch)
+
+	Node const* Node::Find(char const* sz,size_t szLen) const
 	{
-		return ((uint8_t)ch & 0x80) != 0;
+		if( type != OBJECT )	return nullptr;
+		if( szLen==0 )	szLen	= strlen(sz);
+		Node const* key	= this + 1;
+		for( uint32_t i=0; i<count; ++i )
+		{
+			char const* raw		= key->str + 1;
+			size_t const rawLen	= key->len - 2;
+			if( memchr(raw,'\\',rawLen) == nullptr )
+			{
+				if( rawLen == szLen && memcmp(raw,sz,szLen) == 0 )	return key + 1;
+			}
+			else
+			{
+				std::string unescaped;
+				if( UnescapeString(raw,rawLen,unescaped) && unescaped.length() == szLen && memcmp(unescaped.data(),sz,szLen) == 0 )
+				{
+					return key + 1;
+				}
+			}
+			key	= (key + 1)->Next();
+		}
+		return nullptr;
 	}
 
-
-
-	//
 	//
+	// Structural index
 	//
-	inline size_t TrimLeft(char const* str,size_t len)
+	bool MappedFile::Open(char const* path)
 	{
-		size_t i	= 0;
-		while( i<len && IsWhiteSpace(&str[i]) )
+		Close();
+#ifdef JSONIC_MMAP
+		int const fd	= ::open(path,O_RDONLY);
+		if( fd < 0 )
 		{
-			i	+= UTF8CharLength(str[i]);
+			return false;
 		}
-		return i;
-	}
-	inline size_t TrimRight(char const* str,size_t len)
-	{
-		if( len==0 )	return 0;
-		size_t k	= len-1;
-		while( k>0 && (IsTrailingUTF8(str[k]) || IsWhiteSpace(&str[k])) )
+		struct stat st;
+		if( fstat(fd,&st) != 0 )
 		{
-			--k;
+			::close(fd);
+			return false;
 		}
-		return len-1 - k;
+		if( st.st_size > 0 )
+		{
+			void* data	= mmap(nullptr,(size_t)st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+			if( data != MAP_FAILED )
+			{
+				mData	= (char const*)data;
+				mSize	= (size_t)st.st_size;
+				mMapped	= true;
+			}
+		}
+		::close(fd);
+		if( mMapped || st.st_size == 0 )
+		{
+			return true;
+		}
+#endif
+		// Reading is the fallback when mapping is unavailable or fails
+		FILE* file	= fopen(path,"rb");
+		if( file == nullptr )
+		{
+			return false;
+		}
+		char chunk[65536];
+		size_t read;
+		while( (read = fread(chunk,1,sizeof(chunk),file)) > 0 )
+		{
+			mBuffer.insert(mBuffer.end(),chunk,chunk + read);
+		}
+		bool const ok	= ferror(file) == 0;
+		fclose(file);
+		if( !ok )
+		{
+			Close();
+			return false;
+		}
+		mData	= mBuffer.data();
+		mSize	= mBuffer.size();
+		return true;
 	}
-	inline bool Trim(char const* str,size_t len,size_t* nFront,size_t* nBack)
+
+	void MappedFile::Close()
 	{
-		*nFront	= TrimLeft(str,len);
-		*nBack	= 0;
-		if( *nFront < len )
+#ifdef JSONIC_MMAP
+		if( mMapped )
 		{
-			*nBack	= TrimRight(str + *nFront,len - *nFront);
+			munmap((void*)mData,mSize);
 		}
-		return *nFront > 0 || *nBack > 0;
+#endif
+		mData	= nullptr;
+		mSize	= 0;
+		mMapped	= false;
+		std::vector<char>().swap(mBuffer);
 	}
-	inline bool Trim(char const* str,size_t len)
+
+	static const char IndexMagic[8]		= { 'J','S','O','N','I','C','I','X' };
+	static const uint32_t IndexVersion	= 1;
+	static const uint64_t IndexSeed		= 0x5bd1e9955bd1e995ULL;
+
+	// Returns the character after the closing quote of the string starting at 'p', or nullptr if it is unterminated
+	inline char const* SkipString(char const* p,char const* end)
 	{
-		size_t nFront,nBack;
-		return Trim(str,len,&nFront,&nBack);
+		++p;
+		for( ;; )
+		{
+			char const* quote	= (char const*)memchr(p,'\"',end - p);
+			if( quote == nullptr )	return nullptr;
+			// The quote is escaped if an odd number of backslashes precede it
+			char const* back	= quote;
+			while( back > p && *(back-1) == '\\' )	--back;
+			p	= quote + 1;
+			if( ((quote - back) & 1) == 0 )	return p;
+		}
 	}
-	inline void Trim(std::string& str)
+
+	// Returns the character after the object or array starting at 'p', matching brackets only
+	inline char const* SkipContainer(char const* p,char const* end)
 	{
-		size_t n,m;
-		size_t len	= str.length();
-		if( Trim(str.c_str(),len,&n,&m) )
+		size_t depth	= 0;
+		while( p < end )
 		{
-			str.erase(len - m,m);
-			str.erase(0,n);
+			switch( *p )
+			{
+				case '\"':
+					p	= SkipString(p,end);
+					if( p == nullptr )	return nullptr;
+					continue;
+				case '{':
+				case '[':
+					++depth;
+					break;
+				case '}':
+				case ']':
+					if( --depth == 0 )	return p + 1;
+					break;
+			}
+			++p;
 		}
+		return nullptr;
 	}
 
-	//
-	// Helper function to parse the inside of JSON quotes
-	// Checks for escape characters
-	//
-	Value ParseString(char const* sz,size_t len)
+	bool StructuralIndex::Build(char const* src,size_t len,uint32_t depth)
 	{
-		char hex[8]		= {0};
-		char const Esc	= '\\';
+		mFile.Close();
+		memset(&mHeader,0,sizeof(mHeader));
+		mEntries	= nullptr;
+		mChildren	= nullptr;
+		mKeys		= nullptr;
+		mBuiltEntries.clear();
+		mBuiltChildren.clear();
+		mBuiltKeys.clear();
+		if( src == nullptr )
+		{
+			return false;
+		}
 
-		Value v(sz,len,len*3/2);
-		char* out	= v.str;
+		enum State { StateKey, StateColon, StateValue, StateNext };
+		struct Frame
+		{
+			uint32_t	entry;
+			bool		object;
+			State		state;
+			size_t		children;	// start of its members in 'pending'
+			uint64_t	keyOffset;	// key of the member being read
+			uint32_t	keyLength;
+		};
+		std::vector<Frame>	open;
+		std::vector<Child>	pending;	// members of the open containers, moved to mBuiltChildren as they close
+		std::string			scratch;
+		State				root	= StateValue;
+		char const*			p		= src;
+		char const*			end		= src + len;
 
-		for( size_t i=0; i<len; ++i )
+		auto Begin	= [&](char const* at,MemberType type) -> uint32_t
 		{
-			char ci	= sz[i];
-			if( ci == Esc )
+			State& state	= open.empty() ? root : open.back().state;
+			if( state != StateValue || mBuiltEntries.size() >= None )	return None;
+			state	= StateNext;
+
+			uint32_t const entry	= (uint32_t)mBuiltEntries.size();
+			Entry const e	= { (uint64_t)(at - src), 0, (uint32_t)type, 0, 0 };
+			mBuiltEntries.push_back(e);
+			if( !open.empty() )
 			{
-				if( i+1 >= len )	return Value(ValueError);
-				ci	= sz[++i];
+				Frame const& o	= open.back();
+				Child const c	= { entry, o.object ? o.keyLength : 0, o.object ? o.keyOffset : 0 };
+				pending.push_back(c);
+			}
+			return entry;
+		};
+		auto Close	= [&](char const* at,bool object) -> bool
+		{
+			if( open.empty() || open.back().object != object )	return false;
+			Frame const& o	= open.back();
+			bool const empty	= pending.size() == o.children;
+			if( o.state != StateNext && !(empty && o.state == (object ? StateKey : StateValue)) )	return false;
 
-				// Quote("), Backslash(\), and Forward-slash(/) are already set once the escape character is removed
-				if( ci=='b' )		ci	= '\b';
-				else if( ci=='f' )	ci	= '\f';
-				else if( ci=='n' )	ci	= '\n';
-				else if( ci=='r' )	ci	= '\r';
-				else if( ci=='t' )	ci	= '\t';
-				else if( ci=='u' )
+			Entry& e	= mBuiltEntries[o.entry];
+			e.length	= (at + 1 - src) - e.offset;
+			e.count		= (uint32_t)(pending.size() - o.children);
+			e.first		= mBuiltChildren.size();
+			if( object )
+			{
+				// Sorted for binary search, duplicates stay in document order so the first one is found
+				char const* keys	= mBuiltKeys.data();
+				std::stable_sort(pending.begin() + o.children,pending.end(),[keys](Child const& a,Child const& b)
+				{
+					int const order	= memcmp(keys + a.keyOffset,keys + b.keyOffset,a.keyLength < b.keyLength ? a.keyLength : b.keyLength);
+					return order < 0 || (order == 0 && a.keyLength < b.keyLength);
+				});
+			}
+			mBuiltChildren.insert(mBuiltChildren.end(),pending.begin() + o.children,pending.end());
+			pending.resize(o.children);
+			open.pop_back();
+			return true;
+		};
+
+		bool ok	= true;
+		while( ok && p < end )
+		{
+			char const ch	= *p;
+			State* state	= open.empty() ? &root : &open.back().state;
+			if( ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t' )
+			{
+				++p;
+			}
+			else if( ch == '\"' && *state == StateKey )
+			{
+				char const* close	= SkipString(p,end);
+				if( close == nullptr )	break;
+				char const* name	= p + 1;
+				size_t length		= close - name - 1;
+				if( memchr(name,'\\',length) != nullptr )
+				{
+					scratch.clear();
+					if( !UnescapeString(name,length,scratch) )	break;
+					name	= scratch.data();
+					length	= scratch.length();
+				}
+				if( length >= UINT32_MAX )	break;
+				Frame& o		= open.back();
+				o.keyOffset	= mBuiltKeys.size();
+				o.keyLength	= (uint32_t)length;
+				o.state		= StateColon;
+				mBuiltKeys.append(name,length);
+				p	= close;
+			}
+			else if( ch == ':' )
+			{
+				ok	= *state == StateColon;
+				*state	= StateValue;
+				++p;
+			}
+			else if( ch == ',' )
+			{
+				ok	= *state == StateNext && !open.empty();
+				*state	= !open.empty() && open.back().object ? StateKey : StateValue;
+				++p;
+			}
+			else if( ch == '{' || ch == '[' )
+			{
+				bool const object		= ch == '{';
+				uint32_t const entry	= Begin(p,object ? OBJECT : ARRAY);
+				if( entry == None )	break;
+				if( open.size() >= depth )
 				{
-					if( i+4 >= len )	return Value(ValueError);
-					hex[0]	= sz[++i];	hex[1]	= sz[++i];	hex[2]	= sz[++i];	hex[3]	= sz[++i];
-					uint32_t code	= (uint32_t)strtol(hex,nullptr,16);
-					int num = UTF32toUTF8Char(code, hex);
-					for( int k=0; k<num-1; ++k )
-					{
-						*out++	= hex[k];
-					}
-					ci	= hex[num-1];
+					// Below the indexed depth only the extent is needed
+					char const* close	= SkipContainer(p,end);
+					if( close == nullptr )	break;
+					mBuiltEntries[entry].length	= close - p;
+					p	= close;
+					continue;
 				}
+				Frame const o	= { entry, object, object ? StateKey : StateValue, pending.size(), 0, 0 };
+				open.push_back(o);
+				++p;
+			}
+			else if( ch == '}' || ch == ']' )
+			{
+				ok	= Close(p,ch == '}');
+				++p;
+			}
+			else
+			{
+				uint32_t const entry	= Begin(p,VALUE);
+				if( entry == None )	break;
+				char const* after	= ch == '\"' ? SkipString(p,end) : p;
+				if( after == nullptr )	break;
+				while( after < end && strchr(",:]} \n\r\t",*after) == nullptr )	++after;
+				if( after == p )	break;
+				mBuiltEntries[entry].length	= after - p;
+				p	= after;
 			}
-			*out++	= ci;
 		}
-		v.len	= out - v.str;
-		v.str[v.len] = '\0';
-		return v;
+		if( !ok || p < end || !open.empty() || mBuiltEntries.empty() )
+		{
+			mBuiltEntries.clear();
+			mBuiltChildren.clear();
+			mBuiltKeys.clear();
+			return false;
+		}
+
+		memcpy(mHeader.magic,IndexMagic,sizeof(IndexMagic));
+		mHeader.version			= IndexVersion;
+		mHeader.depth			= depth;
+		mHeader.sourceLength	= len;
+		mHeader.checksum		= HashBytes(src,len,IndexSeed);
+		mHeader.entries			= mBuiltEntries.size();
+		mHeader.children		= mBuiltChildren.size();
+		mHeader.keyBytes		= mBuiltKeys.size();
+		mEntries	= mBuiltEntries.data();
+		mChildren	= mBuiltChildren.data();
+		mKeys		= mBuiltKeys.data();
+		return true;
 	}
 
-	Value Member::GetValue() const
+	bool StructuralIndex::Save(char const* path) const
 	{
-		if( str==nullptr || len==0 )
+		if( mHeader.entries == 0 )
 		{
-			return Value(ValueNull);
+			return false;
 		}
-		// Iterator
-		size_t nLeft,nRight;
-		size_t szLen = len;
-		char const* sz = str;
-		if( Trim(str, len, &nLeft, &nRight) )
+		FILE* file	= fopen(path,"wb");
+		if( file == nullptr )
 		{
-			sz		+= nLeft;
-			szLen	-= (nLeft + nRight);
+			return false;
 		}
+		bool ok	= fwrite(&mHeader,sizeof(mHeader),1,file) == 1;
+		ok	= ok && fwrite(mEntries,sizeof(Entry),(size_t)mHeader.entries,file) == mHeader.entries;
+		ok	= ok && fwrite(mChildren,sizeof(Child),(size_t)mHeader.children,file) == mHeader.children;
+		ok	= ok && fwrite(mKeys,1,(size_t)mHeader.keyBytes,file) == mHeader.keyBytes;
+		ok	= fclose(file) == 0 && ok;
+		return ok;
+	}
 
-		if( *sz == '\"' )
+	bool StructuralIndex::Open(char const* path)
+	{
+		memset(&mHeader,0,sizeof(mHeader));
+		mEntries	= nullptr;
+		mChildren	= nullptr;
+		mKeys		= nullptr;
+		mBuiltEntries.clear();
+		mBuiltChildren.clear();
+		mBuiltKeys.clear();
+		if( !mFile.Open(path) )
 		{
-			if( szLen < 2 )
-			{
-				return Value(ValueError);
-			}
-			sz++;
-			szLen	-= 2;
-			if( *(sz+szLen) != '\"' )
-			{
-				// No closing quote
-				return Value(ValueError);
-			}
-			return ParseString(sz,szLen);
+			return false;
 		}
 
-		static char szTrue[]	= {'t','r','u','e',0};
-		static char szFalse[]	= {'f','a','l','s','e'};
-		static char szNull[]	= {'n','u','l','l',0};
-		int nTrue	= 0;
-		int nFalse	= 0;
-		int nNull	= 0;
-		for( size_t i=0; i<5; ++i )
+		Header header;
+		size_t const size	= mFile.Size();
+		if( size < sizeof(header) )
 		{
-			if( *(sz+i) == szTrue[i] )	nTrue++;
-			if( *(sz+i) == szFalse[i] )	nFalse++;
-			if( *(sz+i) == szNull[i] )	nNull++;
+			mFile.Close();
+			return false;
 		}
-		if( nTrue==4 )	return Value(true);
-		if( nFalse==5 )	return Value(false);
-		if( nNull==4 )	return Value(ValueNull);
-
-		char* pEnd;
-		errno		= 0;
-		double num	= strtod(sz,&pEnd);
-		if( errno == ERANGE || pEnd==str )
+		memcpy(&header,mFile.Data(),sizeof(header));
+		// The sections must fill the file exactly, counts are bounded first so the sum cannot overflow
+		if( memcmp(header.magic,IndexMagic,sizeof(IndexMagic)) != 0 || header.version != IndexVersion
+			|| header.entries == 0 || header.entries > None || header.children > size || header.keyBytes > size
+			|| sizeof(header) + header.entries * sizeof(Entry) + header.children * sizeof(Child) + header.keyBytes != size )
 		{
-			return Value(ValueError);
+			mFile.Close();
+			return false;
 		}
-		return Value(num);
+		mHeader		= header;
+		mEntries	= (Entry const*)(mFile.Data() + sizeof(header));
+		mChildren	= (Child const*)(mEntries + header.entries);
+		mKeys		= (char const*)(mChildren + header.children);
+		return true;
 	}
 
-	Member const* Member::Find(char const* sz,size_t szLen) const
+	bool StructuralIndex::Matches(char const* src,size_t len) const
 	{
-		if( szLen==0 )	szLen	= strlen(sz);
-		for( size_t i=0; i<members.size(); ++i )
+		return mHeader.entries > 0 && len == mHeader.sourceLength && HashBytes(src,len,IndexSeed) == mHeader.checksum;
+	}
+
+	// Entries and children are checked as they are used, since a mapped index is not read up front
+	StructuralIndex::Entry const* StructuralIndex::GetEntry(uint32_t entry) const
+	{
+		return entry < mHeader.entries ? &mEntries[entry] : nullptr;
+	}
+
+	uint32_t StructuralIndex::Find(uint32_t entry,char const* sz,size_t len) const
+	{
+		Entry const* e	= GetEntry(entry);
+		if( e == nullptr || e->type != OBJECT || e->first > mHeader.children || e->count > mHeader.children - e->first )
 		{
-			Member const& m	= members[i];
-			if( m.type==KEY )
+			return None;
+		}
+		if( len == 0 )
+		{
+			len	= strlen(sz);
+		}
+		Child const* lo	= mChildren + e->first;
+		Child const* hi	= lo + e->count;
+		while( lo < hi )
+		{
+			Child const* mid	= lo + (hi - lo) / 2;
+			if( mid->keyOffset > mHeader.keyBytes || mid->keyLength > mHeader.keyBytes - mid->keyOffset )
 			{
-				Value v	= m.GetValue();
-				if( szLen==v.len && szLen>0 && strncmp(v.AsString(),sz,szLen)==0 )
-				{
-					return (i<members.size()-1)? &members[i+1] : nullptr;
-				}
+				return None;
 			}
+			int order	= memcmp(mKeys + mid->keyOffset,sz,mid->keyLength < len ? mid->keyLength : len);
+			if( order == 0 )	order = mid->keyLength < len ? -1 : (mid->keyLength > len ? 1 : 0);
+			if( order < 0 )	lo = mid + 1;
+			else			hi = mid;
 		}
-		return nullptr;
+		if( lo == mChildren + e->first + e->count || lo->keyLength != len || memcmp(mKeys + lo->keyOffset,sz,len) != 0 )
+		{
+			return None;
+		}
+		return lo->entry < mHeader.entries ? lo->entry : None;
 	}
-	Member const* Member::FindRecursive(char const* sz,size_t szLen) const
+
+	uint32_t StructuralIndex::At(uint32_t entry,size_t index) const
 	{
-		if( szLen==0 )	szLen	= strlen(sz);
-		for( size_t i=0; i<members.size(); ++i )
+		Entry const* e	= GetEntry(entry);
+		if( e == nullptr || e->type != ARRAY || index >= e->count || e->first + index >= mHeader.children )
 		{
-			Member const& m	= members[i];
-			if( m.type==KEY )
-			{
-				Value v	= m.GetValue();
-				if( szLen==v.len && szLen>0 && strncmp(v.AsString(),sz,szLen)==0 )
-				{
-					return (i<members.size()-1)? &members[i+1] : nullptr;
-				}
-			}
-			else
-			{
-				Member const* p = m.Find(sz,szLen);
-				if( p != nullptr )	return p;
-			}
+			return None;
 		}
-		return nullptr;
+		uint32_t const element	= mChildren[e->first + index].entry;
+		return element < mHeader.entries ? element : None;
 	}
 
-	bool Parse(Member& root)
+	bool StructuralIndex::Parse(uint32_t entry,char const* src,size_t len,Member& out,std::string& buffer,int flags) const
 	{
-		static const char BlockBegin	= '{';
-		static const char BlockEnd		= '}';
-		static const char ArrayBegin	= '[';
-		static const char ArrayEnd		= ']';
-		static const char Separator		= ',';
-		static const char ValueBegin	= ':';
-		static const char Quote			= '\"';
-
-		if( root.str == nullptr || root.len < 2 )
+		Entry const* e	= GetEntry(entry);
+		if( e == nullptr || src == nullptr || len != mHeader.sourceLength || e->offset > len || e->length > len - e->offset )
 		{
 			return false;
 		}
-	
-		Member* pv		= &root;
-		pv->type		= VALUE;
-		char const* psz	= pv->str;
-
-		std::vector<Member*>	stack;
-		// Pseudo push the first brace (don't call PushVar, since it's not being added to a parent)
-		stack.push_back(pv);
+		// Member parsing needs a terminated string, which a span of a mapped source is not
+		buffer.assign(src + e->offset,(size_t)e->length);
+		out	= Member(buffer.c_str(),buffer.length());
+		if( e->type == VALUE )
+		{
+			out.type	= VALUE;
+			return true;
+		}
+		return jsonic::Parse(out,flags);
+	}
 
-		std::function<void(MemberType)> PushVar	= [&](MemberType type)
+#if defined(JSONIC_ZLIB) || defined(JSONIC_ZSTD)
+	//
+	// Compressed input
+	//
+	ChunkQueue::ChunkQueue(size_t chunks,size_t chunkSize) : mStorage(chunks),mChunkSize(chunkSize),mClosed(false),mCancelled(false),mSucceeded(false)
+	{
+		for( std::string& chunk : mStorage )
 		{
-			stack.push_back(pv);
-			pv->members.push_back(Member());
+			chunk.reserve(chunkSize);
+			mFree.push_back(&chunk);
+		}
+	}
 
-			pv	= &pv->members.back();
-			pv->type	= type;
-			// psz points to delimiter
-			pv->str		= psz + 1;
-			pv->len		= 0;
-		};
+	std::string* ChunkQueue::Acquire()
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mChanged.wait(lock,[&]() { return mCancelled || !mFree.empty(); });
+		if( mCancelled )	return nullptr;
+		std::string* chunk	= mFree.back();
+		mFree.pop_back();
+		chunk->clear();
+		return chunk;
+	}
 
-		std::function<bool()> PopVar	= [&]()
+	void ChunkQueue::Push(std::string* chunk)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mFull.push_back(chunk);
+		mChanged.notify_all();
+	}
+
+	void ChunkQueue::Close(bool ok)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mClosed		= true;
+		mSucceeded	= ok;
+		mChanged.notify_all();
+	}
+
+	std::string* ChunkQueue::Pop()
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mChanged.wait(lock,[&]() { return mClosed || !mFull.empty(); });
+		if( mFull.empty() )	return nullptr;
+		std::string* chunk	= mFull.front();
+		mFull.pop_front();
+		return chunk;
+	}
+
+	void ChunkQueue::Release(std::string* chunk)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mFree.push_back(chunk);
+		mChanged.notify_all();
+	}
+
+	void ChunkQueue::Cancel()
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mCancelled	= true;
+		mChanged.notify_all();
+	}
+
+	bool ChunkQueue::Succeeded()
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		return mClosed && mSucceeded;
+	}
+
+#ifdef JSONIC_ZLIB
+	bool Inflate(unsigned char const* src,size_t len,ChunkQueue& queue)
+	{
+		z_stream z;
+		memset(&z,0,sizeof(z));
+		// 32 detects a gzip or zlib header
+		if( inflateInit2(&z,15 + 32) != Z_OK )	return false;
+		bool ok	= false;
+		std::string* chunk	= nullptr;
+		for( ;; )
 		{
-			// psz should be a delimiter, so don't include it in len
-			// the exception is quotes, see Quote section in loop
-			pv->len	= psz - pv->str;
-			if( stack.size()>0 )
+			if( z.avail_in == 0 && len > 0 )
 			{
-				pv	= stack.back();
-				stack.pop_back();
-				return true;
+				uInt const n	= len < (1u << 30) ? (uInt)len : (1u << 30);
+				z.next_in	= (Bytef*)src;
+				z.avail_in	= n;
+				src	+= n;
+				len	-= n;
 			}
-			return false;
-		};
-	
-		while( *psz != '\0' )
-		{
-			if( *psz == Quote )
+			if( chunk == nullptr && (chunk = queue.Acquire()) == nullptr )	break;
+			size_t const used	= chunk->length();
+			chunk->resize(queue.ChunkSize());
+			z.next_out	= (Bytef*)&(*chunk)[used];
+			z.avail_out	= (uInt)(chunk->length() - used);
+			int const result	= inflate(&z,Z_NO_FLUSH);
+			chunk->resize(chunk->length() - z.avail_out);
+			if( chunk->length() == queue.ChunkSize() )
 			{
-				if( pv->type == OBJECT )
-				{
-					// We need to keep quotes, but discard every other delimiter
-					--psz; PushVar(KEY); ++psz;
-				}
-				else if( pv->type != VALUE )
-				{
-					return false;
-				}
-
-				do
-				{
-					++psz;
-				}while( *psz!='\0' && (*psz!=Quote || *(psz-1)=='\\') );
-			
-				if( pv->type == KEY )
-				{
-					++psz; PopVar(); --psz;
-				}
+				queue.Push(chunk);
+				chunk	= nullptr;
 			}
-			else if( *psz == BlockBegin )
+
+			bool const consumed	= z.avail_in == 0 && len == 0;
+			if( result == Z_STREAM_END )
 			{
-				if( pv->type==VALUE )
-				{
-					pv->type	= OBJECT;
-				}
-				else
+				if( consumed )
 				{
-					PushVar(OBJECT);
+					ok	= true;
+					break;
 				}
+				// Another gzip member follows
+				if( inflateReset(&z) != Z_OK )	break;
 			}
-			else if( *psz == ValueBegin )
+			else if( result != Z_OK && result != Z_BUF_ERROR )
 			{
-				if( pv->type != OBJECT )	return false;
-				PushVar(VALUE);
+				break;
 			}
-			else if( *psz == ArrayBegin )
+			else if( result == Z_BUF_ERROR && consumed )
 			{
-				if( pv->type != VALUE )	return false;
-				pv->type	= ARRAY;
-				PushVar(VALUE);
+				break;	// truncated
 			}
-			else if( *psz == Separator )
+		}
+		if( chunk && ok && !chunk->empty() )
+		{
+			queue.Push(chunk);
+			chunk	= nullptr;
+		}
+		if( chunk )	queue.Release(chunk);
+		inflateEnd(&z);
+		return ok;
+	}
+#endif
+
+#ifdef JSONIC_ZSTD
+	bool Unzstd(unsigned char const* src,size_t len,ChunkQueue& queue)
+	{
+		ZSTD_DStream* z	= ZSTD_createDStream();
+		if( z == nullptr )	return false;
+		ZSTD_inBuffer in	= { src, len, 0 };
+		bool ok			= true;
+		size_t pending	= 1;	// non zero while a frame is incomplete
+		std::string* chunk	= nullptr;
+		while( ok && (in.pos < in.size || pending != 0) )
+		{
+			if( chunk == nullptr && (chunk = queue.Acquire()) == nullptr )
 			{
-				if( pv->type == VALUE )
-				{
-					if( !PopVar() )	return false;
-				}
-				if( pv->type==ARRAY )
-				{
-					PushVar(VALUE);
-				}
+				ok	= false;
+				break;
 			}
-			else if( *psz == ArrayEnd )
+			size_t const used	= chunk->length();
+			chunk->resize(queue.ChunkSize());
+			ZSTD_outBuffer out	= { &(*chunk)[0], chunk->length(), used };
+			size_t const before	= in.pos;
+			pending	= ZSTD_decompressStream(z,&out,&in);
+			chunk->resize(out.pos);
+			if( ZSTD_isError(pending) || (in.pos == before && out.pos == used && in.pos == in.size) )
 			{
-				if( pv->type == VALUE )
-				{
-					if( !PopVar() )	return false;
-				}
-
-				if( !PopVar() )	return false;
+				ok	= false;	// corrupt or truncated
+				break;
 			}
-			else if( *psz == BlockEnd )
+			if( chunk->length() == queue.ChunkSize() )
 			{
-				if( pv->type == VALUE )
-				{
-					if( !PopVar() )	return false;
-				}
-
-				if( !PopVar() )	return false;
+				queue.Push(chunk);
+				chunk	= nullptr;
 			}
-			++psz;
 		}
-		return stack.size()==0;
+		if( chunk && ok && !chunk->empty() )
+		{
+			queue.Push(chunk);
+			chunk	= nullptr;
+		}
+		if( chunk )	queue.Release(chunk);
+		ZSTD_freeDStream(z);
+		return ok;
 	}
+#endif
+
+	void Decompress(char const* src,size_t len,ChunkQueue& queue)
+	{
+		unsigned char const* p	= (unsigned char const*)src;
+		bool ok	= false;
+#ifdef JSONIC_ZSTD
+		if( len >= 4 && p[0]==0x28 && p[1]==0xb5 && p[2]==0x2f && p[3]==0xfd )
+		{
+			ok	= Unzstd(p,len,queue);
+		}
+		else
+#endif
+#ifdef JSONIC_ZLIB
+		// gzip magic, or a zlib header: deflate with at most a 32KB window and a check value that is a multiple of 31
+		if( len >= 2 && ((p[0]==0x1f && p[1]==0x8b) || ((p[0] & 0x0f) == 8 && (p[0] >> 4) <= 7 && (p[0]*256 + p[1]) % 31 == 0)) )
+		{
+			ok	= Inflate(p,len,queue);
+		}
+		else
+#endif
+		{
+			ok	= false;
+		}
+		queue.Close(ok);
+	}
+#endif
 
 	void BuildNode::PrintNode(BuildNode const& node, std::string& json)
 	{
@@ -958,6 +5970,63 @@ namespace jsonic
 				break;
 		};
 	}
+
+	void BuildNode::PrintNode(BuildNode const& node, std::string& out, Format format)
+	{
+		if( format == FormatJSON )
+		{
+			PrintNode(node, out);
+			return;
+		}
+
+		BinaryWriter w(out, format);
+		// The count of the enclosing container is already written, so a value must always be one item
+		auto Value	= [&](std::string const& v)
+		{
+			size_t const mark	= out.length();
+			WriterEvents<BinaryWriter> events(w);
+			if( !ParseEvents(v.c_str(), v.length(), events) )
+			{
+				out.resize(mark);
+				w.Null();
+			}
+		};
+		std::function<void(BuildNode const&)> Write	= [&](BuildNode const& n)
+		{
+			switch( n.type )
+			{
+				case MemberType::OBJECT:
+					w.BeginObject(n.nodes.size());
+					for( BuildNode const& child : n.nodes )
+					{
+						Write(child);
+					}
+					break;
+				case MemberType::KEY:
+					w.Key(n.mKey.c_str(), n.mKey.length());
+					Write(n.nodes.front());
+					break;
+				case MemberType::ARRAY:
+					w.BeginArray(n.values.size() + n.nodes.size());
+					for( std::string const& v : n.values )
+					{
+						Value(v);
+					}
+					for( BuildNode const& child : n.nodes )
+					{
+						Write(child);
+					}
+					break;
+				case MemberType::VALUE:
+					// Values are stored as JSON text
+					Value(n.values.front());
+					break;
+				default:
+					break;
+			};
+		};
+		Write(node);
+	}
 };
 #endif
 
@@ -0,0 +1,926 @@
+
+//
+// Jsonic benchmark suite
+//
+// Measures Parse, ParseEvents, GetValue, Find and BuildNode::PrintNode separately over the standard corpora
+// (twitter.json, canada.json, citm_catalog.json) and a set of generated documents.
+// Standard corpora are read from JSONIC_BENCH_DATA, or bench/data, and skipped when missing.
+//
+// Use --benchmark_format=json or --benchmark_out=<file> for machine readable results
+//
+
+#define JSONIC_IMPLEMENTATION
+#include "Jsonic.h"
+
+#include <benchmark/benchmark.h>
+
+#include <fstream>
+#include <new>
+#include <random>
+#include <sstream>
+
+
+//
+// Allocation counting
+//
+static size_t gAllocations	= 0;
+
+#ifdef JSONIC_BENCH_WRAP_MALLOC
+extern "C" void* __real_malloc(size_t size);
+extern "C" void __real_free(void* p);
+extern "C" void* __wrap_malloc(size_t size)	{ ++gAllocations; return __real_malloc(size); }
+extern "C" void __wrap_free(void* p)		{ __real_free(p); }
+static void* RawAlloc(size_t size)			{ return __real_malloc(size); }
+static void RawFree(void* p)				{ __real_free(p); }
+#else
+static void* RawAlloc(size_t size)			{ return malloc(size); }
+static void RawFree(void* p)				{ free(p); }
+#endif
+
+void* operator new(size_t size)
+{
+	++gAllocations;
+	void* p	= RawAlloc(size > 0 ? size : 1);
+	if( p == nullptr )	throw std::bad_alloc();
+	return p;
+}
+void* operator new[](size_t size)					{ return operator new(size); }
+void operator delete(void* p) noexcept				{ RawFree(p); }
+void operator delete[](void* p) noexcept			{ RawFree(p); }
+void operator delete(void* p,size_t) noexcept		{ RawFree(p); }
+void operator delete[](void* p,size_t) noexcept		{ RawFree(p); }
+
+
+//
+// A corpus is one JSON document, or one document per line for NDJSON
+//
+struct Corpus
+{
+	std::string					name;
+	std::vector<std::string>	docs;
+	size_t						bytes	= 0;
+
+	// Prepared once for the access and print benchmarks
+	std::vector<jsonic::Member>									trees;
+	std::vector<jsonic::BuildNode>								builds;
+	std::vector<jsonic::Member const*>							scalars;
+	std::vector<std::pair<jsonic::Member const*,std::string>>	lookups;
+
+	// Parsed with ParseCompactArrays for the bulk decoding benchmark
+	std::vector<jsonic::Member>				compactTrees;
+	std::vector<jsonic::Member const*>		numericArrays;
+
+	// Parsed with a key table shared by all documents for the KeyId lookups
+	jsonic::KeyTable										keys;
+	std::vector<jsonic::Member>								keyTrees;
+	std::vector<std::pair<jsonic::Member const*,jsonic::KeyId>>	keyLookups;
+
+	// Columns typed from the first row when the document is an array of objects
+	std::vector<jsonic::Column>				columns;
+};
+
+static void SplitLines(Corpus& c,std::string const& text)
+{
+	std::istringstream in(text);
+	std::string line;
+	while( std::getline(in,line) )
+	{
+		if( !line.empty() )
+		{
+			c.bytes	+= line.length();
+			c.docs.push_back(line);
+		}
+	}
+}
+
+static bool LoadFile(std::string const& path,std::string& text)
+{
+	std::ifstream in(path,std::ios::binary);
+	if( !in )	return false;
+	std::ostringstream ss;
+	ss << in.rdbuf();
+	text	= ss.str();
+	return true;
+}
+
+
+//
+// Generated corpora
+//
+static std::string RandomWord(std::mt19937& rng,size_t len)
+{
+	static const char letters[]	= "abcdefghijklmnopqrstuvwxyz";
+	std::string s;
+	for( size_t i=0; i<len; ++i )
+	{
+		s	+= letters[rng() % 26];
+	}
+	return s;
+}
+
+// Many deeply nested chains alternating objects and arrays
+static std::string GenerateDeep()
+{
+	std::string s	= "[";
+	for( int chain=0; chain<200; ++chain )
+	{
+		if( chain > 0 )	s += ',';
+		for( int d=0; d<100; ++d )
+		{
+			s	+= (d & 1) ? "[" : "{\"level\":" + std::to_string(d) + ",\"next\":";
+		}
+		s	+= "\"leaf\"";
+		for( int d=99; d>=0; --d )
+		{
+			s	+= (d & 1) ? "]" : "}";
+		}
+	}
+	return s + "]";
+}
+
+// A single object with a very large number of keys
+static std::string GenerateWide()
+{
+	std::mt19937 rng(1);
+	std::string s	= "{";
+	for( int i=0; i<100000; ++i )
+	{
+		if( i > 0 )	s += ',';
+		s	+= "\"key_" + std::to_string(i) + "\":" + std::to_string(rng() % 100000);
+	}
+	return s + "}";
+}
+
+// A large array of integers and doubles with varied exponents
+static std::string GenerateNumeric()
+{
+	std::mt19937 rng(2);
+	std::uniform_real_distribution<double> mantissa(-1.0,1.0);
+	std::uniform_int_distribution<int> exponent(-20,20);
+	std::string s	= "[";
+	char buf[32];
+	for( int i=0; i<200000; ++i )
+	{
+		if( i > 0 )	s += ',';
+		if( i % 3 == 0 )
+		{
+			s	+= std::to_string((int)(rng() % 2000000) - 1000000);
+		}
+		else
+		{
+			snprintf(buf,sizeof(buf),"%.17g",mantissa(rng) * pow(10.0,exponent(rng)));
+			s	+= buf;
+		}
+	}
+	return s + "]";
+}
+
+// An array of long strings with escapes and multi byte characters
+static std::string GenerateStrings()
+{
+	std::mt19937 rng(3);
+	static char const* pieces[]	= { "\\n", "\\t", "\\\"", "\\\\", "\\u00e9", "\\u4e2d", "\xc3\xa9", "\xe4\xb8\xad" };
+	std::string s	= "[";
+	for( int i=0; i<50000; ++i )
+	{
+		if( i > 0 )	s += ',';
+		s	+= '\"';
+		for( int w=0; w<8; ++w )
+		{
+			s	+= RandomWord(rng,3 + rng() % 8);
+			s	+= (rng() % 4 == 0) ? pieces[rng() % 8] : " ";
+		}
+		s	+= '\"';
+	}
+	return s + "]";
+}
+
+// An array of flat records with the same keys
+static std::string GenerateRows()
+{
+	std::mt19937 rng(5);
+	std::string s	= "[";
+	for( int i=0; i<100000; ++i )
+	{
+		if( i > 0 )	s += ',';
+		s	+= "{\"ts\":" + std::to_string(1600000000000LL + i * 37);
+		s	+= ",\"id\":" + std::to_string(rng() % 1000000);
+		s	+= ",\"v\":" + std::to_string((rng() % 1000000) / 1000.0);
+		s	+= ",\"name\":\"" + RandomWord(rng,6) + "\"";
+		s	+= ",\"ok\":" + std::string((rng() & 1) ? "true" : "false") + "}";
+	}
+	return s + "]";
+}
+
+// One small record per line
+static std::string GenerateNDJSON()
+{
+	std::mt19937 rng(4);
+	std::string s;
+	for( int i=0; i<50000; ++i )
+	{
+		s	+= "{\"id\":" + std::to_string(i);
+		s	+= ",\"ts\":" + std::to_string(1600000000000LL + i * 37);
+		s	+= ",\"user\":\"" + RandomWord(rng,8) + "\"";
+		s	+= ",\"active\":" + std::string((rng() & 1) ? "true" : "false");
+		s	+= ",\"score\":" + std::to_string((rng() % 100000) / 100.0);
+		s	+= ",\"tags\":[\"" + RandomWord(rng,4) + "\",\"" + RandomWord(rng,5) + "\"]";
+		s	+= ",\"parent\":null}\n";
+	}
+	return s;
+}
+
+
+//
+// Tree helpers
+//
+static size_t CountNodes(jsonic::Member const& m)
+{
+	size_t n	= 1;
+	for( jsonic::Member const& child : m.members )
+	{
+		n	+= CountNodes(child);
+	}
+	return n;
+}
+
+static void CollectScalars(jsonic::Member const& m,std::vector<jsonic::Member const*>& out)
+{
+	if( m.type == jsonic::KEY || m.type == jsonic::VALUE )
+	{
+		out.push_back(&m);
+	}
+	for( jsonic::Member const& child : m.members )
+	{
+		CollectScalars(child,out);
+	}
+}
+
+// Collects the arrays that decode as numbers
+static void CollectNumericArrays(jsonic::Member const& m,std::vector<jsonic::Member const*>& out)
+{
+	std::vector<double> numbers;
+	if( m.type == jsonic::ARRAY && m.Size() > 0 && m.GetArray(numbers) )
+	{
+		out.push_back(&m);
+	}
+	for( jsonic::Member const& child : m.members )
+	{
+		CollectNumericArrays(child,out);
+	}
+}
+
+// Collects up to 'perObject' evenly spaced keys of every object so wide objects don't dominate
+static void CollectLookups(jsonic::Member const& m,std::vector<std::pair<jsonic::Member const*,std::string>>& out,size_t perObject)
+{
+	if( m.type == jsonic::OBJECT )
+	{
+		size_t const keys	= m.members.size() / 2;
+		size_t const step	= keys > perObject ? keys / perObject : 1;
+		for( size_t k=0; k<keys; k+=step )
+		{
+			jsonic::Value key	= m.members[k*2].GetValue();
+			out.push_back(std::make_pair(&m,std::string(key.AsString(),key.len)));
+		}
+	}
+	for( jsonic::Member const& child : m.members )
+	{
+		CollectLookups(child,out,perObject);
+	}
+}
+
+static jsonic::BuildNode ToBuildNode(jsonic::Member const& m)
+{
+	if( m.type == jsonic::OBJECT )
+	{
+		jsonic::BuildNode node;
+		for( size_t i=0; i+1<m.members.size(); i+=2 )
+		{
+			jsonic::Value key	= m.members[i].GetValue();
+			node.AddNode(std::string(key.AsString(),key.len),ToBuildNode(m.members[i+1]));
+		}
+		return node;
+	}
+	if( m.type == jsonic::ARRAY )
+	{
+		std::vector<jsonic::BuildNode> list;
+		for( jsonic::Member const& child : m.members )
+		{
+			list.push_back(ToBuildNode(child));
+		}
+		return jsonic::BuildNode(list);
+	}
+	jsonic::Value v	= m.GetValue();
+	if( v.IsString() )	return jsonic::BuildNode(std::string(v.AsString(),v.len));
+	if( v.IsNumber() )	return jsonic::BuildNode(v.AsDouble());
+	if( v.IsBoolean() )	return jsonic::BuildNode(v.AsBoolean());
+	return jsonic::BuildNode(nullptr);
+}
+
+
+//
+// Benchmarks
+//
+static void SetCounters(benchmark::State& state,size_t bytes,size_t items,char const* perItem,size_t allocs,size_t docs)
+{
+	state.SetBytesProcessed((int64_t)(state.iterations() * bytes));
+	state.counters["nodes"]		= (double)items;
+	// Inverted rate is seconds per item, printed with an SI prefix (e.g. 25n is 25ns)
+	state.counters[perItem]		= benchmark::Counter((double)items * state.iterations(),benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+	state.counters["allocs/doc"]	= (double)allocs / (docs > 0 ? docs : 1);
+}
+
+static void BM_Parse(benchmark::State& state,Corpus const* c)
+{
+	size_t nodes	= 0;
+	size_t const before	= gAllocations;
+	for( std::string const& doc : c->docs )
+	{
+		jsonic::Member root(doc.c_str(),doc.length());
+		if( !jsonic::Parse(root) )
+		{
+			state.SkipWithError("Parse failed");
+			return;
+		}
+		nodes	+= CountNodes(root);
+	}
+	size_t const allocs	= gAllocations - before;
+
+	for( auto _ : state )
+	{
+		for( std::string const& doc : c->docs )
+		{
+			jsonic::Member root(doc.c_str(),doc.length());
+			bool ok	= jsonic::Parse(root);
+			benchmark::DoNotOptimize(ok);
+			benchmark::DoNotOptimize(root.members.data());
+		}
+	}
+	SetCounters(state,c->bytes,nodes,"time/node",allocs,c->docs.size());
+}
+
+// Buffers are sized for the worst case, so capacity never runs out
+static void BM_ParseNodes(benchmark::State& state,Corpus const* c)
+{
+	size_t largest	= 0;
+	for( std::string const& doc : c->docs )
+	{
+		if( doc.length() > largest )	largest = doc.length();
+	}
+	std::vector<jsonic::Node> nodes(largest / 2 + 1);
+	std::vector<uint32_t> depth(largest / 2 + 1);
+	jsonic::NodeSpan const nodeSpan		= { nodes.data(), nodes.size() };
+	jsonic::DepthSpan const depthSpan	= { depth.data(), depth.size() };
+
+	size_t count	= 0;
+	size_t used		= 0;
+	size_t const before	= gAllocations;
+	for( std::string const& doc : c->docs )
+	{
+		if( !jsonic::Parse(doc.c_str(),doc.length(),nodeSpan,depthSpan,&count) )
+		{
+			state.SkipWithError("Parse into nodes failed");
+			return;
+		}
+		used	+= count;
+	}
+	size_t const allocs	= gAllocations - before;
+
+	for( auto _ : state )
+	{
+		for( std::string const& doc : c->docs )
+		{
+			bool ok	= jsonic::Parse(doc.c_str(),doc.length(),nodeSpan,depthSpan,&count);
+			benchmark::DoNotOptimize(ok);
+			benchmark::DoNotOptimize(nodes.data());
+		}
+	}
+	SetCounters(state,c->bytes,used,"time/node",allocs,c->docs.size());
+}
+
+// Counts events so the parse can't be optimized away
+struct CountEvents : jsonic::EventHandler<CountEvents>
+{
+	size_t	events	= 0;
+	bool OnNull()							{ ++events; return true; }
+	bool OnBoolean(bool)					{ ++events; return true; }
+	bool OnNumber(double)					{ ++events; return true; }
+	bool OnInteger(int64_t)					{ ++events; return true; }
+	bool OnString(char const*,size_t)		{ ++events; return true; }
+	bool OnKey(char const*,size_t)			{ ++events; return true; }
+	bool OnStartObject()					{ ++events; return true; }
+	bool OnStartArray()						{ ++events; return true; }
+};
+
+static void BM_ParseEvents(benchmark::State& state,Corpus const* c)
+{
+	CountEvents counter;
+	size_t const before	= gAllocations;
+	for( std::string const& doc : c->docs )
+	{
+		if( !jsonic::ParseEvents(doc.c_str(),doc.length(),counter) )
+		{
+			state.SkipWithError("ParseEvents failed");
+			return;
+		}
+	}
+	size_t const allocs	= gAllocations - before;
+	size_t const events	= counter.events;
+
+	for( auto _ : state )
+	{
+		for( std::string const& doc : c->docs )
+		{
+			bool ok	= jsonic::ParseEvents(doc.c_str(),doc.length(),counter);
+			benchmark::DoNotOptimize(ok);
+		}
+	}
+	SetCounters(state,c->bytes,events,"time/node",allocs,c->docs.size());
+}
+
+static void BM_GetValue(benchmark::State& state,Corpus const* c)
+{
+	std::vector<jsonic::Member const*> const& scalars	= c->scalars;
+	size_t const before	= gAllocations;
+	for( jsonic::Member const* m : scalars )
+	{
+		jsonic::Value v	= m->GetValue();
+		benchmark::DoNotOptimize(v);
+	}
+	size_t const allocs	= gAllocations - before;
+
+	for( auto _ : state )
+	{
+		for( jsonic::Member const* m : scalars )
+		{
+			jsonic::Value v	= m->GetValue();
+			benchmark::DoNotOptimize(v);
+		}
+	}
+	SetCounters(state,c->bytes,scalars.size(),"time/node",allocs,c->docs.size());
+}
+
+static void BM_GetArray(benchmark::State& state,Corpus const* c)
+{
+	std::vector<jsonic::Member const*> const& arrays	= c->numericArrays;
+	std::vector<double> numbers;
+	size_t elements	= 0;
+	for( jsonic::Member const* m : arrays )
+	{
+		m->GetArray(numbers);
+		elements	+= numbers.size();
+	}
+	size_t const before	= gAllocations;
+	for( jsonic::Member const* m : arrays )
+	{
+		m->GetArray(numbers);
+	}
+	size_t const allocs	= gAllocations - before;
+
+	for( auto _ : state )
+	{
+		for( jsonic::Member const* m : arrays )
+		{
+			bool ok	= m->GetArray(numbers);
+			benchmark::DoNotOptimize(ok);
+			benchmark::DoNotOptimize(numbers.data());
+		}
+	}
+	SetCounters(state,c->bytes,elements,"time/node",allocs,c->docs.size());
+}
+
+static void BM_ExtractColumns(benchmark::State& state,Corpus const* c)
+{
+	jsonic::Member const& rows	= c->trees.front();
+	size_t const threads	= (size_t)state.range(0);
+	std::vector<jsonic::Column> columns	= c->columns;
+	size_t const before	= gAllocations;
+	if( !jsonic::ExtractColumns(rows,columns,threads) )
+	{
+		state.SkipWithError("ExtractColumns failed");
+		return;
+	}
+	size_t const allocs	= gAllocations - before;
+
+	for( auto _ : state )
+	{
+		bool ok	= jsonic::ExtractColumns(rows,columns,threads);
+		benchmark::DoNotOptimize(ok);
+		benchmark::DoNotOptimize(columns.data());
+	}
+	SetCounters(state,c->bytes,rows.Size() * columns.size(),"time/node",allocs,c->docs.size());
+}
+
+// Validation against a schema of the rows, as events (0) or while building the tree (1)
+static void BM_Validate(benchmark::State& state,Corpus const* c)
+{
+	static char const schemaJson[]	= "{\"type\":\"array\",\"items\":{\"type\":\"object\",\"required\":[\"ts\",\"id\",\"v\"],\"properties\":{"
+									  "\"ts\":{\"type\":\"integer\",\"minimum\":0},\"id\":{\"type\":\"integer\",\"maximum\":1000000},"
+									  "\"v\":{\"type\":\"number\"},\"name\":{\"type\":\"string\",\"maxLength\":16},\"ok\":{\"type\":\"boolean\"}}}}";
+	jsonic::Schema schema;
+	if( !schema.Compile(schemaJson,sizeof(schemaJson) - 1) )
+	{
+		state.SkipWithError("Schema failed");
+		return;
+	}
+	jsonic::SchemaValidator validator(schema);
+	bool const tree	= state.range(0) != 0;
+	auto Validate	= [&](std::string const& doc) -> bool
+	{
+		if( !tree )
+		{
+			validator.Reset();
+			return jsonic::ParseEvents(doc.c_str(),doc.length(),validator);
+		}
+		jsonic::Member root(doc.c_str(),doc.length());
+		return jsonic::Parse(root,validator);
+	};
+
+	size_t const before	= gAllocations;
+	for( std::string const& doc : c->docs )
+	{
+		if( !Validate(doc) )
+		{
+			state.SkipWithError(validator.Error().c_str());
+			return;
+		}
+	}
+	size_t const allocs	= gAllocations - before;
+
+	for( auto _ : state )
+	{
+		for( std::string const& doc : c->docs )
+		{
+			bool ok	= Validate(doc);
+			benchmark::DoNotOptimize(ok);
+		}
+	}
+	SetCounters(state,c->bytes,c->trees.front().Size(),"time/row",allocs,c->docs.size());
+}
+
+// Building the sidecar index of the rows, one level deep
+static void BM_BuildIndex(benchmark::State& state,Corpus const* c)
+{
+	std::string const& doc	= c->docs.front();
+	auto Build	= [&]() -> bool
+	{
+		jsonic::StructuralIndex index;
+		return index.Build(doc.c_str(),doc.length(),1);
+	};
+	size_t const before	= gAllocations;
+	if( !Build() )
+	{
+		state.SkipWithError("Build failed");
+		return;
+	}
+	size_t const allocs	= gAllocations - before;
+
+	for( auto _ : state )
+	{
+		bool ok	= Build();
+		benchmark::DoNotOptimize(ok);
+	}
+	SetCounters(state,c->bytes,c->trees.front().Size(),"time/row",allocs,c->docs.size());
+}
+
+// Startup from a saved index: open it and parse 100 rows, instead of parsing the whole document
+static void BM_IndexLookup(benchmark::State& state,Corpus const* c)
+{
+	std::string const& doc	= c->docs.front();
+	std::string const path	= "jsonic_bench.index";
+	{
+		jsonic::StructuralIndex index;
+		if( !index.Build(doc.c_str(),doc.length(),1) || !index.Save(path.c_str()) )
+		{
+			state.SkipWithError("Index failed");
+			return;
+		}
+	}
+	std::vector<size_t> rows;
+	std::mt19937 rng(6);
+	for( int i=0; i<100; ++i )
+	{
+		rows.push_back(rng() % c->trees.front().Size());
+	}
+
+	std::string buffer;
+	auto Lookup	= [&]() -> bool
+	{
+		jsonic::StructuralIndex index;
+		bool ok	= index.Open(path.c_str());
+		for( size_t row : rows )
+		{
+			jsonic::Member member(nullptr,0);
+			ok	= ok && index.Parse(index.At(index.Root(),row),doc.c_str(),doc.length(),member,buffer);
+			benchmark::DoNotOptimize(member.members.data());
+		}
+		return ok;
+	};
+	size_t const before	= gAllocations;
+	if( !Lookup() )
+	{
+		remove(path.c_str());
+		state.SkipWithError("Lookup failed");
+		return;
+	}
+	size_t const allocs	= gAllocations - before;
+
+	for( auto _ : state )
+	{
+		bool ok	= Lookup();
+		benchmark::DoNotOptimize(ok);
+	}
+	remove(path.c_str());
+	SetCounters(state,c->bytes,rows.size(),"time/row",allocs,c->docs.size());
+}
+
+#ifdef JSONIC_ZLIB
+static std::string Gzip(std::string const& text)
+{
+	z_stream z;
+	memset(&z,0,sizeof(z));
+	std::string out(compressBound((uLong)text.length()) + 32,'\0');
+	// 16 writes a gzip header
+	deflateInit2(&z,Z_DEFAULT_COMPRESSION,Z_DEFLATED,15 + 16,8,Z_DEFAULT_STRATEGY);
+	z.next_in	= (Bytef*)text.data();
+	z.avail_in	= (uInt)text.length();
+	z.next_out	= (Bytef*)&out[0];
+	z.avail_out	= (uInt)out.length();
+	deflate(&z,Z_FINISH);
+	out.resize(z.total_out);
+	deflateEnd(&z);
+	return out;
+}
+
+// Decompression and event parsing of the whole corpus as one gzip stream, NDJSON as a sequence of documents
+static void BM_ParseCompressed(benchmark::State& state,Corpus const* c)
+{
+	bool const documents	= c->docs.size() > 1;
+	std::string text;
+	for( std::string const& doc : c->docs )
+	{
+		text	+= doc;
+		text	+= '\n';
+	}
+	std::string const compressed	= Gzip(text);
+
+	CountEvents counter;
+	size_t const before	= gAllocations;
+	if( !jsonic::ParseCompressed(compressed.data(),compressed.length(),counter,documents) )
+	{
+		state.SkipWithError("ParseCompressed failed");
+		return;
+	}
+	size_t const allocs	= gAllocations - before;
+	size_t const events	= counter.events;
+
+	for( auto _ : state )
+	{
+		bool ok	= jsonic::ParseCompressed(compressed.data(),compressed.length(),counter,documents);
+		benchmark::DoNotOptimize(ok);
+	}
+	SetCounters(state,c->bytes,events,"time/node",allocs,c->docs.size());
+}
+#endif
+
+static void BM_Find(benchmark::State& state,Corpus const* c)
+{
+	std::vector<std::pair<jsonic::Member const*,std::string>> const& lookups	= c->lookups;
+	size_t const before	= gAllocations;
+	for( auto const& l : lookups )
+	{
+		benchmark::DoNotOptimize(l.first->Find(l.second.c_str(),l.second.length()));
+	}
+	size_t const allocs	= gAllocations - before;
+
+	for( auto _ : state )
+	{
+		for( auto const& l : lookups )
+		{
+			benchmark::DoNotOptimize(l.first->Find(l.second.c_str(),l.second.length()));
+		}
+	}
+	SetCounters(state,c->bytes,lookups.size(),"time/lookup",allocs,c->docs.size());
+}
+
+static void BM_FindId(benchmark::State& state,Corpus const* c)
+{
+	std::vector<std::pair<jsonic::Member const*,jsonic::KeyId>> const& lookups	= c->keyLookups;
+	size_t const before	= gAllocations;
+	for( auto const& l : lookups )
+	{
+		benchmark::DoNotOptimize(l.first->Find(l.second));
+	}
+	size_t const allocs	= gAllocations - before;
+
+	for( auto _ : state )
+	{
+		for( auto const& l : lookups )
+		{
+			benchmark::DoNotOptimize(l.first->Find(l.second));
+		}
+	}
+	SetCounters(state,c->bytes,lookups.size(),"time/lookup",allocs,c->docs.size());
+}
+
+// Reformatting without a tree, Minify (0) or Prettify (1)
+static void BM_Reformat(benchmark::State& state,Corpus const* c)
+{
+	bool const pretty	= state.range(0) != 0;
+	std::string out;
+	auto Reformat	= [&](std::string const& doc) -> bool
+	{
+		out.clear();
+		return pretty ? jsonic::Prettify(doc.c_str(),doc.length(),out) : jsonic::Minify(doc.c_str(),doc.length(),out);
+	};
+	size_t const before	= gAllocations;
+	for( std::string const& doc : c->docs )
+	{
+		if( !Reformat(doc) )
+		{
+			state.SkipWithError("Reformat failed");
+			return;
+		}
+	}
+	size_t const allocs	= gAllocations - before;
+
+	for( auto _ : state )
+	{
+		for( std::string const& doc : c->docs )
+		{
+			bool ok	= Reformat(doc);
+			benchmark::DoNotOptimize(ok);
+			benchmark::DoNotOptimize(out.data());
+		}
+	}
+	SetCounters(state,c->bytes,c->docs.size(),"time/doc",allocs,c->docs.size());
+}
+
+static void BM_PrintNode(benchmark::State& state,Corpus const* c)
+{
+	size_t nodes	= 0;
+	size_t bytes	= 0;
+	size_t const before	= gAllocations;
+	for( size_t i=0; i<c->builds.size(); ++i )
+	{
+		std::string json;
+		jsonic::BuildNode::PrintNode(c->builds[i],json);
+		bytes	+= json.length();
+		nodes	+= CountNodes(c->trees[i]);
+	}
+	size_t const allocs	= gAllocations - before;
+
+	for( auto _ : state )
+	{
+		for( jsonic::BuildNode const& node : c->builds )
+		{
+			std::string json;
+			jsonic::BuildNode::PrintNode(node,json);
+			benchmark::DoNotOptimize(json.data());
+		}
+	}
+	// Bytes are output bytes for printing
+	SetCounters(state,bytes,nodes,"time/node",allocs,c->docs.size());
+}
+
+
+int main(int argc,char** argv)
+{
+	char const* dataEnv	= getenv("JSONIC_BENCH_DATA");
+	std::string const dataDir	= dataEnv ? dataEnv : JSONIC_BENCH_DATA_DIR;
+
+	std::vector<std::unique_ptr<Corpus>> corpora;
+	auto Add	= [&](std::string const& name,std::string const& text,bool ndjson)
+	{
+		corpora.push_back(std::unique_ptr<Corpus>(new Corpus()));
+		Corpus& c	= *corpora.back();
+		c.name		= name;
+		if( ndjson )
+		{
+			SplitLines(c,text);
+		}
+		else
+		{
+			c.docs.push_back(text);
+			c.bytes	= text.length();
+		}
+	};
+
+	for( char const* file : { "twitter.json", "canada.json", "citm_catalog.json" } )
+	{
+		std::string text;
+		if( LoadFile(dataDir + "/" + file,text) )
+		{
+			Add(std::string(file).substr(0,strlen(file) - 5),text,false);
+		}
+		else
+		{
+			fprintf(stderr,"jsonic_bench: %s/%s not found, skipping\n",dataDir.c_str(),file);
+		}
+	}
+	Add("deep",GenerateDeep(),false);
+	Add("wide",GenerateWide(),false);
+	Add("numeric",GenerateNumeric(),false);
+	Add("strings",GenerateStrings(),false);
+	Add("rows",GenerateRows(),false);
+	Add("ndjson",GenerateNDJSON(),true);
+
+	// Trees point into the documents, which no longer move from here on
+	for( std::unique_ptr<Corpus>& c : corpora )
+	{
+		for( std::string const& doc : c->docs )
+		{
+			c->trees.push_back(jsonic::Member(doc.c_str(),doc.length()));
+			jsonic::Parse(c->trees.back());
+		}
+		for( jsonic::Member const& tree : c->trees )
+		{
+			c->builds.push_back(ToBuildNode(tree));
+			CollectScalars(tree,c->scalars);
+			CollectLookups(tree,c->lookups,16);
+		}
+		for( std::string const& doc : c->docs )
+		{
+			c->compactTrees.push_back(jsonic::Member(doc.c_str(),doc.length()));
+			jsonic::Parse(c->compactTrees.back(),jsonic::ParseCompactArrays);
+		}
+		for( jsonic::Member const& tree : c->compactTrees )
+		{
+			CollectNumericArrays(tree,c->numericArrays);
+		}
+
+		for( std::string const& doc : c->docs )
+		{
+			c->keyTrees.push_back(jsonic::Member(doc.c_str(),doc.length()));
+			jsonic::Parse(c->keyTrees.back(),c->keys);
+		}
+		std::vector<std::pair<jsonic::Member const*,std::string>> keyNames;
+		for( jsonic::Member const& tree : c->keyTrees )
+		{
+			CollectLookups(tree,keyNames,16);
+		}
+		for( auto const& l : keyNames )
+		{
+			c->keyLookups.push_back(std::make_pair(l.first,c->keys.Lookup(l.second.c_str(),l.second.length())));
+		}
+
+		jsonic::Member const& first	= c->trees.front();
+		if( c->trees.size() == 1 && first.type == jsonic::ARRAY && first.Size() > 0 && first.members[0].type == jsonic::OBJECT )
+		{
+			std::vector<jsonic::Member> const& row	= first.members[0].members;
+			for( size_t i=0; i+1<row.size(); i+=2 )
+			{
+				jsonic::Value const k	= row[i].GetValue();
+				jsonic::Value const v	= row[i+1].GetValue();
+				std::string const key	= k.IsString() ? std::string(k.AsString(),k.len) : std::string();
+				if( row[i+1].type != jsonic::VALUE || key.empty() || key.find_first_of("~/") != std::string::npos )
+				{
+					continue;
+				}
+				jsonic::ColumnType const type	= v.IsNumber() ? jsonic::ColumnDouble : v.IsBoolean() ? jsonic::ColumnBoolean : jsonic::ColumnString;
+				c->columns.push_back(jsonic::Column("/" + key,type));
+			}
+		}
+	}
+
+	for( std::unique_ptr<Corpus>& c : corpora )
+	{
+		benchmark::RegisterBenchmark(("Parse/" + c->name).c_str(),BM_Parse,c.get())->Unit(benchmark::kMillisecond);
+		benchmark::RegisterBenchmark(("ParseNodes/" + c->name).c_str(),BM_ParseNodes,c.get())->Unit(benchmark::kMillisecond);
+		benchmark::RegisterBenchmark(("ParseEvents/" + c->name).c_str(),BM_ParseEvents,c.get())->Unit(benchmark::kMillisecond);
+#ifdef JSONIC_ZLIB
+		benchmark::RegisterBenchmark(("ParseCompressed/" + c->name).c_str(),BM_ParseCompressed,c.get())->Unit(benchmark::kMillisecond)->UseRealTime();
+#endif
+		benchmark::RegisterBenchmark(("GetValue/" + c->name).c_str(),BM_GetValue,c.get())->Unit(benchmark::kMillisecond);
+		if( !c->numericArrays.empty() )
+		{
+			benchmark::RegisterBenchmark(("GetArray/" + c->name).c_str(),BM_GetArray,c.get())->Unit(benchmark::kMillisecond);
+		}
+		if( !c->columns.empty() )
+		{
+			benchmark::RegisterBenchmark(("ExtractColumns/" + c->name).c_str(),BM_ExtractColumns,c.get())->Arg(1)->Arg(0)->Unit(benchmark::kMillisecond);
+		}
+		if( c->name == "rows" )
+		{
+			benchmark::RegisterBenchmark(("Validate/" + c->name).c_str(),BM_Validate,c.get())->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+			benchmark::RegisterBenchmark(("BuildIndex/" + c->name).c_str(),BM_BuildIndex,c.get())->Unit(benchmark::kMillisecond);
+			benchmark::RegisterBenchmark(("IndexLookup/" + c->name).c_str(),BM_IndexLookup,c.get())->Unit(benchmark::kMillisecond);
+		}
+		if( !c->lookups.empty() )
+		{
+			benchmark::RegisterBenchmark(("Find/" + c->name).c_str(),BM_Find,c.get())->Unit(benchmark::kMillisecond);
+			benchmark::RegisterBenchmark(("FindId/" + c->name).c_str(),BM_FindId,c.get())->Unit(benchmark::kMillisecond);
+		}
+		benchmark::RegisterBenchmark(("PrintNode/" + c->name).c_str(),BM_PrintNode,c.get())->Unit(benchmark::kMillisecond);
+		benchmark::RegisterBenchmark(("Reformat/" + c->name).c_str(),BM_Reformat,c.get())->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+	}
+
+	benchmark::Initialize(&argc,argv);
+	if( benchmark::ReportUnrecognizedArguments(argc,argv) )
+	{
+		return 1;
+	}
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
@@ -0,0 +1,26 @@
+#ifndef _JSONIC_RECORDER_INCLUDED
+#define _JSONIC_RECORDER_INCLUDED
+
+#include "Test.h"
+
+// Writes every event to a log, so two event sources can be compared
+struct Recorder : jsonic::EventHandler<Recorder>
+{
+	std::string	log;
+	size_t		documents	= 0;
+
+	bool OnNull()								{ log += "null "; return true; }
+	bool OnBoolean(bool b)						{ log += b ? "true " : "false "; return true; }
+	bool OnNumber(double v)						{ char sz[32]; snprintf(sz,sizeof(sz),"d:%.17g ",v); log += sz; return true; }
+	bool OnInteger(int64_t v)					{ log += "i:" + std::to_string(v) + " "; return true; }
+	bool OnUnsigned(uint64_t v)					{ log += "u:" + std::to_string(v) + " "; return true; }
+	bool OnString(char const* sz,size_t len)	{ log += "s:" + std::string(sz,len) + " "; return true; }
+	bool OnKey(char const* sz,size_t len)		{ log += "k:" + std::string(sz,len) + " "; return true; }
+	bool OnStartObject()						{ log += "{ "; return true; }
+	bool OnEndObject()							{ log += "} "; return true; }
+	bool OnStartArray()							{ log += "[ "; return true; }
+	bool OnEndArray()							{ log += "] "; return true; }
+	bool OnEndDocument()						{ log += "| "; ++documents; return true; }
+};
+
+#endif // _JSONIC_RECORDER_INCLUDED
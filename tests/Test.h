@@ -0,0 +1,47 @@
+#ifndef _JSONIC_TEST_INCLUDED
+#define _JSONIC_TEST_INCLUDED
+
+#include "Jsonic.h"
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+
+//
+// Minimal test registry, each source file is a suite that ctest runs by name
+//
+namespace test
+{
+	typedef void (*Function)();
+
+	struct Case
+	{
+		char const*	suite;
+		char const*	name;
+		Function	function;
+	};
+
+	std::vector<Case>& Cases();
+	void Fail(char const* file,int line,char const* expression);
+
+	struct Register
+	{
+		Register(char const* suite,char const* name,Function function)
+		{
+			Case const c	= { suite, name, function };
+			Cases().push_back(c);
+		}
+	};
+
+	inline std::string Str(char const* sz)	{ return std::string(sz,strlen(sz)); }
+}
+
+#define TEST(suite,name) \
+	static void suite##_##name(); \
+	static test::Register suite##_##name##_register(#suite,#name,suite##_##name); \
+	static void suite##_##name()
+
+#define CHECK(expression) \
+	do { if( !(expression) ) test::Fail(__FILE__,__LINE__,#expression); } while( 0 )
+
+#endif // _JSONIC_TEST_INCLUDED
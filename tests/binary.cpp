@@ -0,0 +1,173 @@
+#include "Test.h"
+
+using namespace jsonic;
+
+static char const* const Documents[]	=
+{
+	"{\"a\":1,\"b\":[true,false,null],\"c\":\"text\"}",
+	"[0,-1,127,128,255,256,65535,65536,-32,-33,-129,-32769,4294967296,-9223372036854775808,9223372036854775807]",
+	"[0.5,-2.25,1e300,3.141592653589793]",
+	"{\"escaped\":\"quote \\\" slash \\\\ tab \\t unicode \\u00e9\",\"empty\":\"\"}",
+	"{\"nested\":{\"list\":[[],{},[{}],{\"x\":[1,[2,[3]]]}]}}",
+	"[]",
+	"{}",
+};
+
+// JSON text written the way Transcode writes it, to compare round trips
+static std::string Canonical(std::string const& json)
+{
+	std::string out;
+	CHECK(Transcode(json.c_str(),json.length(),FormatJSON,FormatJSON,out));
+	return out;
+}
+
+static void RoundTrip(Format format)
+{
+	for( char const* doc : Documents )
+	{
+		std::string const json	= test::Str(doc);
+		std::string packed;
+		CHECK(Transcode(json.c_str(),json.length(),FormatJSON,format,packed));
+
+		std::string back;
+		CHECK(Transcode(packed.data(),packed.size(),format,FormatJSON,back));
+		CHECK(back == Canonical(json));
+
+		Member root(packed.data(),packed.size(),format);
+		CHECK(Parse(root));
+	}
+}
+
+TEST(binary,MsgPackRoundTrip)
+{
+	RoundTrip(FormatMsgPack);
+}
+
+TEST(binary,CBORRoundTrip)
+{
+	RoundTrip(FormatCBOR);
+}
+
+TEST(binary,MemberAccess)
+{
+	std::string const json	= test::Str(Documents[0]);
+	for( Format format : { FormatMsgPack, FormatCBOR } )
+	{
+		std::string packed;
+		CHECK(Transcode(json.c_str(),json.length(),FormatJSON,format,packed));
+		Member root(packed.data(),packed.size(),format);
+		CHECK(Parse(root));
+		Member const* a	= root.Find("a");
+		Member const* c	= root.Find("c");
+		CHECK(a != nullptr && a->GetValue().AsInt() == 1);
+		CHECK(c != nullptr && strcmp(c->GetValue().AsString(),"text") == 0);
+		CHECK(root.Find("missing") == nullptr);
+	}
+}
+
+TEST(binary,BuildNodeOutput)
+{
+	BuildNode root;
+	root.AddNode("width",BuildNode((int)100));
+	root.AddNode("ratio",BuildNode(0.5));
+	root.AddNode("list",BuildNode(std::vector<int>{ 1, 2, 3 }));
+	std::string json;
+	BuildNode::PrintNode(root,json);
+	for( Format format : { FormatMsgPack, FormatCBOR } )
+	{
+		std::string packed;
+		BuildNode::PrintNode(root,packed,format);
+		std::string back;
+		CHECK(Transcode(packed.data(),packed.size(),format,FormatJSON,back));
+		CHECK(back == Canonical(json));
+	}
+}
+
+// Every proper prefix of an encoding is incomplete, and must fail without output
+TEST(binary,Truncated)
+{
+	std::string const json	= test::Str(Documents[4]);
+	for( Format format : { FormatMsgPack, FormatCBOR } )
+	{
+		std::string packed;
+		CHECK(Transcode(json.c_str(),json.length(),FormatJSON,format,packed));
+		for( size_t len=0; len<packed.size(); ++len )
+		{
+			std::string const prefix	= packed.substr(0,len);
+			std::string out	= "unchanged";
+			CHECK(!Transcode(prefix.data(),prefix.size(),format,FormatJSON,out));
+			CHECK(out == "unchanged");
+			Member root(prefix.data(),prefix.size(),format);
+			CHECK(!Parse(root));
+		}
+	}
+}
+
+TEST(binary,InvalidJSON)
+{
+	char const* const invalid[]	= { "{\"a\":}", "[1,,2]", "{\"a\" 1}", "[1", "\"open" };
+	for( char const* doc : invalid )
+	{
+		std::string out;
+		CHECK(!Transcode(doc,strlen(doc),FormatJSON,FormatMsgPack,out));
+		CHECK(out.empty());
+	}
+}
+
+// Integers above INT64_MAX keep every digit instead of going through double
+TEST(binary,Unsigned)
+{
+	char const json[]	= "[18446744073709551615,9223372036854775808,-9223372036854775808]";
+	std::string text;
+	CHECK(Transcode(json,sizeof(json) - 1,FormatJSON,FormatJSON,text));
+	CHECK(text == json);
+	for( Format format : { FormatMsgPack, FormatCBOR } )
+	{
+		std::string packed;
+		CHECK(Transcode(json,sizeof(json) - 1,FormatJSON,format,packed));
+		std::string back;
+		CHECK(Transcode(packed.data(),packed.size(),format,FormatJSON,back));
+		CHECK(back == json);
+	}
+}
+
+// A value that is not JSON text still takes its place in the container, as null
+TEST(binary,BuildNodeInvalidValue)
+{
+	BuildNode root;
+	root.AddNode("bad",BuildNode(NAN));
+	root.AddNode("list",BuildNode(std::vector<double>{ 1.0, NAN, 2.0 }));
+	root.AddNode("after",BuildNode(true));
+	for( Format format : { FormatMsgPack, FormatCBOR } )
+	{
+		std::string packed;
+		BuildNode::PrintNode(root,packed,format);
+		std::string back;
+		CHECK(Transcode(packed.data(),packed.size(),format,FormatJSON,back));
+		CHECK(back == "{\"bad\":null,\"list\":[1.0,null,2.0],\"after\":true}");
+	}
+}
+
+// Chunks of an indefinite CBOR string must be definite strings of the same major type
+TEST(binary,IndefiniteStrings)
+{
+	std::string const valid	= test::Str("\x82\x7f\x61\x61\x62\x62\x63\xff\x5f\x41\x78\xff");
+	Member root(valid.data(),valid.size(),FormatCBOR);
+	CHECK(Parse(root));
+	CHECK(strcmp(root.GetValue(0).AsString(),"abc") == 0);
+	CHECK(strcmp(root.GetValue(1).AsString(),"x") == 0);
+
+	std::string const invalid[]	= { test::Str("\x81\x7f\x80\xff"),			// an array as a chunk
+									test::Str("\x81\x7f\x41\x78\xff"),		// a byte string chunk in a text string
+									test::Str("\x81\x5f\x61\x78\xff"),		// a text string chunk in a byte string
+									test::Str("\x81\x7f\x7f\xff\xff"),		// an indefinite chunk
+									test::Str("\x81\x7f\xc1\x61\x78\xff"),	// a tagged chunk
+									test::Str("\x81\x7f\x61\x78") };		// no break
+	for( std::string const& cbor : invalid )
+	{
+		Member bad(cbor.data(),cbor.size(),FormatCBOR);
+		CHECK(!Parse(bad));
+		std::string out;
+		CHECK(!Transcode(cbor.data(),cbor.size(),FormatCBOR,FormatJSON,out));
+	}
+}
@@ -0,0 +1,119 @@
+#include "Test.h"
+
+using namespace jsonic;
+
+static std::string Text(Column const& column,size_t row)
+{
+	return std::string(column.strings[row].str,column.strings[row].len);
+}
+
+// Keys of later rows may be in another order than the first row, the hint only saves the search
+TEST(columns,KeyOrder)
+{
+	char const json[]	= "[{\"a\":1,\"b\":\"x\",\"c\":true},{\"c\":false,\"a\":2,\"b\":\"y\"},{\"b\":\"z\",\"c\":true},{\"x\":0,\"a\":4,\"b\":\"w\",\"c\":false}]";
+	Member root(json,sizeof(json) - 1);
+	CHECK(Parse(root));
+	std::vector<Column> columns	= { Column("/a",ColumnInt64), Column("/b",ColumnString), Column("/c",ColumnBoolean) };
+	CHECK(ExtractColumns(root,columns));
+	CHECK(columns[0].rows == 4 && columns[0].integers.size() == 4);
+	CHECK(columns[0].integers[0] == 1 && columns[0].integers[1] == 2 && columns[0].integers[3] == 4);
+	CHECK(columns[0].IsValid(0) && columns[0].IsValid(1) && !columns[0].IsValid(2) && columns[0].IsValid(3));
+	CHECK(columns[0].integers[2] == 0);
+	CHECK(Text(columns[1],0) == "x" && Text(columns[1],1) == "y" && Text(columns[1],2) == "z" && Text(columns[1],3) == "w");
+	CHECK(columns[2].booleans[0] == 1 && columns[2].booleans[1] == 0 && columns[2].booleans[2] == 1 && columns[2].booleans[3] == 0);
+	for( size_t r=0; r<4; ++r )
+	{
+		CHECK(columns[1].IsValid(r) && columns[2].IsValid(r));
+	}
+}
+
+TEST(columns,NestedPaths)
+{
+	char const json[]	= "[{\"user\":{\"id\":7,\"a/b\":1.5}},{\"user\":{\"a/b\":2.5}},{\"user\":3},{},{\"user\":{\"id\":9,\"a/b\":null}}]";
+	Member root(json,sizeof(json) - 1);
+	CHECK(Parse(root));
+	std::vector<Column> columns	= { Column("/user/id",ColumnInt64), Column("/user/a~1b",ColumnDouble), Column("/missing/x",ColumnString) };
+	CHECK(ExtractColumns(root,columns));
+	CHECK(columns[0].valid.size() == 1);
+	CHECK(columns[0].valid[0] == 0x11);	// rows 0 and 4
+	CHECK(columns[0].integers[0] == 7 && columns[0].integers[4] == 9);
+	CHECK(columns[1].valid[0] == 0x03);
+	CHECK(columns[1].doubles[0] == 1.5 && columns[1].doubles[1] == 2.5);
+	CHECK(columns[2].valid[0] == 0);
+
+	// Not a JSON Pointer, or not an array
+	std::vector<Column> bad	= { Column("user",ColumnInt64) };
+	CHECK(!ExtractColumns(root,bad));
+	std::vector<Column> escape	= { Column("/user~2",ColumnInt64) };
+	CHECK(!ExtractColumns(root,escape));
+	std::vector<Column> fine	= { Column("/user",ColumnInt64) };
+	CHECK(!ExtractColumns(root.members[0],fine));
+}
+
+// A value of another type leaves the row invalid instead of failing the column
+TEST(columns,Conversions)
+{
+	char const json[]	= "[{\"v\":1},{\"v\":2.5},{\"v\":\"3\"},{\"v\":true},{\"v\":null},{\"v\":[1]},{\"v\":{\"x\":1}},{\"v\":1e2},{\"v\":\"a\\\"b\"},{\"v\":1e400}]";
+	Member root(json,sizeof(json) - 1);
+	CHECK(Parse(root));
+	std::vector<Column> columns	= { Column("/v",ColumnDouble), Column("/v",ColumnInt64), Column("/v",ColumnBoolean), Column("/v",ColumnString) };
+	CHECK(ExtractColumns(root,columns));
+	CHECK(columns[0].valid[0] == 0x083);	// 1, 2.5 and 1e2
+	CHECK(columns[0].doubles[1] == 2.5 && columns[0].doubles[7] == 100);
+	CHECK(columns[1].valid[0] == 0x081);	// 1 and 1e2, not 2.5
+	CHECK(columns[1].integers[7] == 100);
+	CHECK(columns[2].valid[0] == 0x008);
+	CHECK(columns[3].valid[0] == 0x104);
+	CHECK(Text(columns[3],2) == "3");
+	CHECK(Text(columns[3],8) == "a\\\"b");	// escapes are kept
+
+	// Compact arrays have no objects, every row is invalid
+	char const numbers[]	= "[1,2,3]";
+	Member compact(numbers,sizeof(numbers) - 1);
+	CHECK(Parse(compact,ParseCompactArrays));
+	std::vector<Column> values	= { Column("/v",ColumnDouble) };
+	CHECK(ExtractColumns(compact,values));
+	CHECK(values[0].rows == 3 && values[0].valid[0] == 0);
+}
+
+// Splitting rows across threads must give the same columns as one thread
+TEST(columns,Threads)
+{
+	std::string json	= "[";
+	for( int r=0; r<5000; ++r )
+	{
+		if( r )	json += ",";
+		if( r % 7 == 0 )		json += "{\"name\":\"n" + std::to_string(r) + "\",\"id\":" + std::to_string(r) + "}";
+		else if( r % 11 == 0 )	json += "{\"id\":\"x\"}";
+		else					json += "{\"id\":" + std::to_string(r) + ",\"price\":" + std::to_string(r) + ".5,\"ok\":" + (r % 2 ? "true" : "false") + ",\"name\":\"n" + std::to_string(r) + "\"}";
+	}
+	json	+= "]";
+	Member root(json.c_str(),json.length());
+	CHECK(Parse(root));
+
+	auto Extract	= [&](size_t threads)
+	{
+		std::vector<Column> columns	= { Column("/id",ColumnInt64), Column("/price",ColumnDouble), Column("/ok",ColumnBoolean), Column("/name",ColumnString) };
+		CHECK(ExtractColumns(root,columns,threads));
+		return columns;
+	};
+	std::vector<Column> const one	= Extract(1);
+	CHECK(one[0].IsValid(0) && !one[0].IsValid(11) && one[1].IsValid(1) && !one[1].IsValid(7));
+	for( size_t threads : { 0, 2, 3, 8, 64 } )
+	{
+		std::vector<Column> const many	= Extract(threads);
+		for( size_t c=0; c<one.size(); ++c )
+		{
+			CHECK(many[c].rows == one[c].rows);
+			CHECK(many[c].valid == one[c].valid);
+			CHECK(many[c].doubles == one[c].doubles);
+			CHECK(many[c].integers == one[c].integers);
+			CHECK(many[c].booleans == one[c].booleans);
+			CHECK(many[c].strings.size() == one[c].strings.size());
+			for( size_t r=0; r<one[c].strings.size(); ++r )
+			{
+				CHECK(many[c].strings[r].str == one[c].strings[r].str && many[c].strings[r].len == one[c].strings[r].len);
+			}
+		}
+	}
+}
@@ -0,0 +1,129 @@
+#include "Recorder.h"
+
+using namespace jsonic;
+
+#if defined(JSONIC_ZLIB) || defined(JSONIC_ZSTD)
+
+// Enough lines to span several 64KB chunks
+static std::string Lines()
+{
+	std::string text;
+	for( int i=0; i<5000; ++i )
+	{
+		text	+= "{\"id\":" + std::to_string(i) + ",\"name\":\"row " + std::to_string(i) + "\",\"values\":[1.5,true,null]}\n";
+	}
+	return text;
+}
+
+static std::string Expected(std::string const& text)
+{
+	Recorder recorder;
+	EventStream<Recorder> stream(recorder,true);
+	CHECK(stream.Feed(text.data(),text.length()) && stream.Finish());
+	return recorder.log;
+}
+
+struct Thrower : EventHandler<Thrower>
+{
+	size_t	count	= 0;
+	bool OnNumber(double)	{ if( ++count == 3000 ) throw std::runtime_error("stop"); return true; }
+};
+
+static void CheckCompressed(std::string const& text,std::string const& compressed)
+{
+	Recorder recorder;
+	CHECK(ParseCompressed(compressed.data(),compressed.size(),recorder,true));
+	CHECK(recorder.log == Expected(text));
+	CHECK(recorder.documents == 5000);
+
+	size_t lines	= 0;
+	CHECK(ParseCompressedLines(compressed.data(),compressed.size(),[&](Member& root) {
+		Member const* id	= root.Find("id");
+		CHECK(id != nullptr && id->GetValue().AsInt() == (int)lines);
+		++lines;
+		return true;
+	}));
+	CHECK(lines == 5000);
+
+	// Stopping early cancels the decompression
+	lines	= 0;
+	CHECK(!ParseCompressedLines(compressed.data(),compressed.size(),[&](Member&) { return ++lines < 10; }));
+	CHECK(lines == 10);
+
+	// An exception from the handler reaches the caller, after the producer thread is joined
+	Thrower thrower;
+	bool thrown	= false;
+	try
+	{
+		ParseCompressed(compressed.data(),compressed.size(),thrower,true);
+	}
+	catch( std::runtime_error const& )
+	{
+		thrown	= true;
+	}
+	CHECK(thrown);
+
+	// Corrupt or truncated data fails
+	std::string damaged	= compressed;
+	damaged[damaged.size() / 2]	^= 0x55;
+	Recorder ignored;
+	CHECK(!ParseCompressed(damaged.data(),damaged.size(),ignored,true));
+	CHECK(!ParseCompressed(compressed.data(),compressed.size() / 2,ignored,true));
+}
+
+#endif
+
+#ifdef JSONIC_ZLIB
+TEST(compressed,Gzip)
+{
+	std::string const text	= Lines();
+	z_stream z;
+	memset(&z,0,sizeof(z));
+	// 16 writes a gzip header
+	CHECK(deflateInit2(&z,Z_DEFAULT_COMPRESSION,Z_DEFLATED,15 + 16,8,Z_DEFAULT_STRATEGY) == Z_OK);
+	std::string compressed(deflateBound(&z,text.length()),'\0');
+	z.next_in	= (Bytef*)text.data();
+	z.avail_in	= (uInt)text.length();
+	z.next_out	= (Bytef*)&compressed[0];
+	z.avail_out	= (uInt)compressed.size();
+	CHECK(deflate(&z,Z_FINISH) == Z_STREAM_END);
+	compressed.resize(z.total_out);
+	deflateEnd(&z);
+	CheckCompressed(text,compressed);
+}
+
+TEST(compressed,Zlib)
+{
+	std::string const text	= Lines();
+	uLongf size	= compressBound((uLong)text.length());
+	std::string compressed(size,'\0');
+	CHECK(compress2((Bytef*)&compressed[0],&size,(Bytef const*)text.data(),(uLong)text.length(),Z_DEFAULT_COMPRESSION) == Z_OK);
+	compressed.resize(size);
+	CHECK((unsigned char)compressed[0] == 0x78);
+	CheckCompressed(text,compressed);
+}
+
+// A first byte that only looks like deflate is not taken as a zlib header
+TEST(compressed,NotCompressed)
+{
+	Recorder recorder;
+	for( char const* sz : { "x{\"a\":1}", "8888", "H[1]", "\x78\x9d", "\x88\x1c", "[1]", "" } )
+	{
+		CHECK(!ParseCompressed(sz,strlen(sz),recorder));
+		CHECK(!ParseCompressedLines(sz,strlen(sz),[](Member&) { return true; }));
+	}
+	CHECK(recorder.log.empty());
+}
+#endif
+
+#ifdef JSONIC_ZSTD
+TEST(compressed,Zstd)
+{
+	std::string const text	= Lines();
+	std::string compressed(ZSTD_compressBound(text.length()),'\0');
+	size_t const n	= ZSTD_compress(&compressed[0],compressed.size(),text.data(),text.length(),3);
+	CHECK(!ZSTD_isError(n));
+	compressed.resize(n);
+	CheckCompressed(text,compressed);
+}
+#endif
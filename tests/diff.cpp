@@ -0,0 +1,87 @@
+#include "Test.h"
+
+using namespace jsonic;
+
+static char const Before[]	= "{\"name\":\"x\",\"items\":[{\"id\":1,\"v\":\"a\"},{\"id\":2,\"v\":\"b\"}],\"meta\":{\"k/1\":true,\"gone\":null},\"n\":[1,2,3]}";
+static char const After[]	= "{\"items\":[{\"id\":1,\"v\":\"a\"},{\"id\":2,\"v\":\"c\"},{\"id\":3}],\"name\":\"x\",\"meta\":{\"k/1\":false,\"new\":1},\"n\":[1,5,3]}";
+
+static std::vector<std::string> Paths(int beforeFlags,int afterFlags)
+{
+	Member before(Before,sizeof(Before) - 1);
+	Member after(After,sizeof(After) - 1);
+	CHECK(Parse(before,beforeFlags));
+	CHECK(Parse(after,afterFlags));
+	std::vector<Difference> differences;
+	Diff(before,after,differences);
+	std::vector<std::string> paths;
+	for( Difference const& d : differences )
+	{
+		paths.push_back(std::to_string(d.type) + d.path);
+	}
+	std::sort(paths.begin(),paths.end());
+	return paths;
+}
+
+TEST(diff,Hashed)
+{
+	std::vector<std::string> const expected	= { "0/items/2", "0/meta/new", "1/meta/gone", "2/items/1/v", "2/meta/k~11", "2/n/1" };
+	CHECK(Paths(ParseHash,ParseHash) == expected);
+	CHECK(Paths(ParseHash | ParseCompactArrays,ParseHash) == expected);
+}
+
+// Without ParseHash every hash is 0, which must not make the trees look equal
+TEST(diff,Unhashed)
+{
+	std::vector<std::string> const expected	= Paths(ParseHash,ParseHash);
+	CHECK(Paths(ParseDefault,ParseDefault) == expected);
+	CHECK(Paths(ParseHash,ParseDefault) == expected);
+	CHECK(Paths(ParseCompactArrays,ParseCompactArrays) == expected);
+
+	Member a(Before,sizeof(Before) - 1);
+	Member b(Before,sizeof(Before) - 1);
+	CHECK(Parse(a) && Parse(b));
+	std::vector<Difference> differences;
+	Diff(a,b,differences);
+	CHECK(differences.empty());
+}
+
+static size_t Count(char const* before,char const* after,int flags,Format format=FormatJSON)
+{
+	std::string a	= test::Str(before);
+	std::string b	= test::Str(after);
+	if( format != FormatJSON )
+	{
+		std::string pa,pb;
+		CHECK(Transcode(a.c_str(),a.length(),FormatJSON,format,pa));
+		CHECK(Transcode(b.c_str(),b.length(),FormatJSON,format,pb));
+		a.swap(pa);
+		b.swap(pb);
+	}
+	Member ma(a.data(),a.size(),format);
+	Member mb(b.data(),b.size(),format);
+	CHECK(Parse(ma,flags) && Parse(mb,flags));
+	std::vector<Difference> differences;
+	Diff(ma,mb,differences);
+	return differences.size();
+}
+
+// Integers above 2^53 round to the same double but are different values
+TEST(diff,LargeIntegers)
+{
+	for( int flags : { (int)ParseDefault, (int)ParseHash, (int)ParseCompactArrays, ParseHash | ParseCompactArrays } )
+	{
+		CHECK(Count("{\"id\":9007199254740993}","{\"id\":9007199254740992}",flags) == 1);
+		CHECK(Count("[1234567890123456789]","[1234567890123456788]",flags) == 1);
+		CHECK(Count("[-9223372036854775807]","[-9223372036854775806]",flags) == 1);
+		CHECK(Count("[18446744073709551615]","[18446744073709551614]",flags) == 1);
+		// Equal values written differently are still equal
+		CHECK(Count("[100,-0,9007199254740992]","[1e2,0,9007199254740992.0]",flags) == 0);
+		CHECK(Count("{\"id\":1234567890123456789}","{\"id\":1234567890123456789}",flags) == 0);
+	}
+	for( Format format : { FormatMsgPack, FormatCBOR } )
+	{
+		CHECK(Count("{\"id\":9007199254740993}","{\"id\":9007199254740992}",ParseHash,format) == 1);
+		CHECK(Count("[1234567890123456789]","[1234567890123456788]",ParseDefault,format) == 1);
+		CHECK(Count("[100]","[100.0]",ParseHash,format) == 0);
+	}
+}
@@ -0,0 +1,80 @@
+#include "Test.h"
+
+using namespace jsonic;
+
+// Whitespace removed outside strings, byte by byte
+static std::string Reference(std::string const& json)
+{
+	std::string out;
+	bool quoted	= false;
+	for( size_t i=0; i<json.length(); ++i )
+	{
+		char const c	= json[i];
+		if( quoted )
+		{
+			out	+= c;
+			if( c == '\\' )		out += json[++i];
+			else if( c == '\"' )	quoted = false;
+		}
+		else if( c == '\"' )
+		{
+			quoted	= true;
+			out		+= c;
+		}
+		else if( c != ' ' && c != '\n' && c != '\r' && c != '\t' )
+		{
+			out	+= c;
+		}
+	}
+	return out;
+}
+
+TEST(format,Minify)
+{
+	// Quotes, backslashes and spaces land at every offset of the 8 byte words
+	for( size_t pad=0; pad<16; ++pad )
+	{
+		std::string const gap(pad,' ');
+		std::string const json	= "{" + gap + "\"k" + std::string(pad,'x') + "\\\\\" : [ 1 ,\t\"a\\\"" + gap + "b\" ,\n"
+								  + gap + "true ] , \"e\" : { } }" + gap;
+		std::string out;
+		CHECK(Minify(json.c_str(),json.length(),out));
+		CHECK(out == Reference(json));
+
+		std::string buffer	= json;
+		size_t len	= buffer.length();
+		CHECK(Minify(&buffer[0],&len));
+		CHECK(buffer.substr(0,len) == out);
+	}
+}
+
+TEST(format,Prettify)
+{
+	char const json[]	= "{\"a\":[1,{\"b\":null}],\"c\":{},\"d\":[],\"e\":\"x \\\" y\"}";
+	std::string out;
+	CHECK(Prettify(json,sizeof(json) - 1,out,2));
+	CHECK(out == "{\n  \"a\": [\n    1,\n    {\n      \"b\": null\n    }\n  ],\n  \"c\": {},\n  \"d\": [],\n  \"e\": \"x \\\" y\"\n}");
+
+	std::string back;
+	CHECK(Minify(out.c_str(),out.length(),back));
+	CHECK(back == json);
+}
+
+TEST(format,Errors)
+{
+	char const* const unterminated[]	= { "\"abc", "[\"a\\\"]", "\"ab\\", "[1,\x01]" };
+	for( char const* doc : unterminated )
+	{
+		std::string out	= "unchanged";
+		CHECK(!Minify(doc,strlen(doc),out));
+		CHECK(!Prettify(doc,strlen(doc),out));
+		CHECK(out == "unchanged");
+	}
+	char const* const unbalanced[]	= { "{\"a\":1]", "[1", "]", "[{]}" };
+	for( char const* doc : unbalanced )
+	{
+		std::string out	= "unchanged";
+		CHECK(!Prettify(doc,strlen(doc),out));
+		CHECK(out == "unchanged");
+	}
+}
@@ -0,0 +1,83 @@
+#include "Test.h"
+
+using namespace jsonic;
+
+static char const Document[]	= " {\"users\":[{\"id\":1,\"name\":\"a\"},{\"id\":2,\"name\":\"b\\\"q\"}],"
+								  "\"meta\":{\"count\":2,\"k\\u0041\":\"x\",\"z\":[]},\"n\":12.5,\"a\":{},\"a\":[1]} ";
+
+TEST(index,Depths)
+{
+	size_t const len	= sizeof(Document) - 1;
+	size_t const sizes[]	= { 1, 6, 12, 16 };
+	for( uint32_t depth=0; depth<4; ++depth )
+	{
+		StructuralIndex index;
+		CHECK(index.Build(Document,len,depth));
+		CHECK(index.Size() == sizes[depth]);
+		uint32_t const users	= index.Find(index.Root(),"users");
+		CHECK((users != StructuralIndex::None) == (depth >= 1));
+		CHECK((index.At(users,1) != StructuralIndex::None) == (depth >= 2));
+		CHECK((index.Find(index.At(users,1),"name") != StructuralIndex::None) == (depth >= 3));
+	}
+}
+
+TEST(index,SaveAndOpen)
+{
+	size_t const len	= sizeof(Document) - 1;
+	char const path[]	= "jsonic_test.index";
+	{
+		StructuralIndex index;
+		CHECK(index.Build(Document,len,2));
+		CHECK(index.Save(path));
+	}
+	StructuralIndex index;
+	CHECK(index.Open(path));
+	CHECK(index.Matches(Document,len));
+	CHECK(index.SourceLength() == len);
+
+	std::string buffer;
+	Member member;
+	CHECK(index.Parse(index.At(index.Find(index.Root(),"users"),1),Document,len,member,buffer));
+	CHECK(member.Find("name") != nullptr && strcmp(member.Find("name")->GetValue().AsString(),"b\"q") == 0);
+	CHECK(index.Parse(index.Find(index.Root(),"n"),Document,len,member,buffer));
+	CHECK(member.GetValue().AsDouble() == 12.5);
+
+	// Keys are unescaped, and the first of duplicate keys is found
+	uint32_t const k	= index.Find(index.Find(index.Root(),"meta"),"kA");
+	CHECK(k != StructuralIndex::None && index.GetEntry(k)->type == VALUE);
+	CHECK(index.GetEntry(index.Find(index.Root(),"a"))->type == OBJECT);
+	CHECK(index.Find(index.Root(),"missing") == StructuralIndex::None);
+	CHECK(index.At(index.Find(index.Root(),"users"),2) == StructuralIndex::None);
+
+	std::string changed(Document,len);
+	changed[10]	= 'U';
+	CHECK(!index.Matches(changed.c_str(),changed.length()));
+	CHECK(!index.Parse(index.Root(),Document,len - 1,member,buffer));
+
+	// A file that is not exactly an index is rejected
+	FILE* file	= fopen(path,"ab");
+	CHECK(file != nullptr);
+	fputc(0,file);
+	fclose(file);
+	StructuralIndex damaged;
+	CHECK(!damaged.Open(path));
+	remove(path);
+	CHECK(!damaged.Open(path));
+}
+
+TEST(index,Errors)
+{
+	char const* const invalid[]	= { "{\"a\":1,}", "[1 2]", "{\"a\" 1}", "[1,[2,]", "{\"a\":\"x}", "[1]]", "1 2", "{\"a\":1}{", "", "[,1]", "{,}" };
+	for( char const* doc : invalid )
+	{
+		StructuralIndex index;
+		CHECK(!index.Build(doc,strlen(doc),3));
+		CHECK(index.Size() == 0);
+	}
+	char const* const valid[]	= { "[]", "{}", "1", "\"x\\\\\"", "[[],{}]" };
+	for( char const* doc : valid )
+	{
+		StructuralIndex index;
+		CHECK(index.Build(doc,strlen(doc),3));
+	}
+}
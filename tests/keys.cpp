@@ -0,0 +1,178 @@
+#include "Test.h"
+#include <thread>
+
+using namespace jsonic;
+
+// Ids of every key in document order
+static std::vector<KeyId> KeyIds(Member const& m)
+{
+	std::vector<KeyId> ids;
+	if( m.type == KEY )	ids.push_back(m.key);
+	for( Member const& child : m.members )
+	{
+		std::vector<KeyId> const inner	= KeyIds(child);
+		ids.insert(ids.end(),inner.begin(),inner.end());
+	}
+	return ids;
+}
+
+TEST(keys,StableAcrossDocuments)
+{
+	KeyTable keys;
+	char const first[]	= "{\"id\":1,\"name\":\"a\",\"nested\":{\"id\":2}}";
+	char const second[]	= "{\"name\":\"b\",\"extra\":true,\"id\":3}";
+	Member a(first,sizeof(first) - 1);
+	Member b(second,sizeof(second) - 1);
+	CHECK(Parse(a,keys));
+	CHECK(Parse(b,keys));
+	CHECK(keys.Size() == 4);
+
+	KeyId const id		= keys.Lookup("id");
+	KeyId const name	= keys.Lookup("name");
+	CHECK(id != KeyNone && name != KeyNone && id != name);
+	CHECK(KeyIds(a) == std::vector<KeyId>({ id, name, keys.Lookup("nested"), id }));
+	CHECK(KeyIds(b) == std::vector<KeyId>({ name, keys.Lookup("extra"), id }));
+
+	CHECK(a.Find(id)->GetValue().AsInt() == 1);
+	CHECK(b.Find(id)->GetValue().AsInt() == 3);
+	CHECK(a.Find(keys.Lookup("nested"))->Find(id)->GetValue().AsInt() == 2);
+	CHECK(a.Find(keys.Lookup("extra")) == nullptr);
+	CHECK(a.Find(KeyNone) == nullptr);
+
+	// A tree parsed without the table has no ids to match
+	Member plain(first,sizeof(first) - 1);
+	CHECK(Parse(plain));
+	CHECK(plain.Find(id) == nullptr);
+	CHECK(plain.Find("id") != nullptr);
+
+	// Binary documents share the ids of JSON ones
+	std::string packed;
+	CHECK(Transcode(second,sizeof(second) - 1,FormatJSON,FormatCBOR,packed));
+	Member c(packed.data(),packed.size(),FormatCBOR);
+	CHECK(Parse(c,keys));
+	CHECK(KeyIds(c) == KeyIds(b));
+	CHECK(c.Find(id)->GetValue().AsInt() == 3);
+}
+
+TEST(keys,LookupAndName)
+{
+	KeyTable keys(16);
+	CHECK(keys.Size() == 0);
+	CHECK(keys.Lookup("a") == KeyNone);
+	KeyId const a	= keys.Intern("a",1);
+	KeyId const b	= keys.Intern("bb",2);
+	CHECK(a == 1 && b == 2);
+	CHECK(keys.Intern("a",1) == a);
+	CHECK(keys.Lookup("a") == a && keys.Lookup("bb",2) == b && keys.Lookup("b") == KeyNone);
+	CHECK(keys.Lookup("bbx",2) == b);	// only len bytes are compared
+	CHECK(keys.Size() == 2);
+
+	CHECK(keys.Name(a) != nullptr && *keys.Name(a) == "a");
+	CHECK(*keys.Name(b) == "bb");
+	CHECK(keys.Name(KeyNone) == nullptr);
+	CHECK(keys.Name((KeyId)3) == nullptr);
+	CHECK(keys.Name((KeyId)17) == nullptr);
+	CHECK(keys.Name((KeyId)0xffffffff) == nullptr);
+
+	// Keys may hold any bytes, including an embedded zero
+	KeyId const zero	= keys.Intern("x\0y",3);
+	CHECK(zero != KeyNone && zero != keys.Intern("x",1));
+	CHECK(keys.Name(zero)->length() == 3);
+}
+
+// Once the table is full new keys are KeyNone, while the keys it holds keep working
+TEST(keys,Capacity)
+{
+	KeyTable keys(2);
+	char const json[]	= "{\"a\":1,\"b\":2,\"c\":3,\"a\":4}";
+	Member root(json,sizeof(json) - 1);
+	CHECK(Parse(root,keys));
+	CHECK(keys.Size() == 2);
+	CHECK(KeyIds(root) == std::vector<KeyId>({ (KeyId)1, (KeyId)2, KeyNone, (KeyId)1 }));
+	CHECK(keys.Lookup("c") == KeyNone);
+	CHECK(keys.Intern("d",1) == KeyNone);
+	CHECK(keys.Intern("b",1) == 2);
+	CHECK(root.Find(keys.Lookup("b"))->GetValue().AsInt() == 2);
+	CHECK(root.Find("c")->GetValue().AsInt() == 3);
+
+	KeyTable none(0);
+	CHECK(none.Intern("a",1) == KeyNone && none.Name((KeyId)1) == nullptr);
+}
+
+// Keys are interned unescaped, so every spelling of a key gets one id
+TEST(keys,Escapes)
+{
+	KeyTable keys;
+	char const json[]	= "{\"caf\\u00e9\":1,\"a\\\"b\":2,\"\\u0069d\":3,\"id\":4,\"tab\\t\":5}";
+	Member root(json,sizeof(json) - 1);
+	CHECK(Parse(root,keys));
+	CHECK(keys.Size() == 4);
+	KeyId const cafe	= keys.Lookup("caf\xc3\xa9");
+	CHECK(cafe != KeyNone && root.Find(cafe)->GetValue().AsInt() == 1);
+	CHECK(root.Find(keys.Lookup("a\"b"))->GetValue().AsInt() == 2);
+	CHECK(root.members[4].key == root.members[6].key);
+	CHECK(root.Find(keys.Lookup("id"))->GetValue().AsInt() == 3);
+	CHECK(*keys.Name(keys.Lookup("tab\t")) == "tab\t");
+}
+
+// Threads parsing documents with overlapping keys at the same time agree on every id
+TEST(keys,Threads)
+{
+	KeyTable keys;
+	size_t const threads	= 8;
+	size_t const distinct	= 300;
+	std::vector<std::vector<KeyId>> seen(threads,std::vector<KeyId>(distinct,KeyNone));
+	std::vector<char> parsed(threads,0);
+
+	auto Work	= [&](size_t t)
+	{
+		bool ok	= true;
+		for( size_t round=0; round<20; ++round )
+		{
+			// Each thread and round walks the keys in a different order
+			std::string json	= "{";
+			for( size_t i=0; i<distinct; ++i )
+			{
+				size_t const k	= (i * 7 + t * 37 + round * 11) % distinct;
+				if( i )	json += ",";
+				json	+= "\"key" + std::to_string(k) + "\":" + std::to_string(k);
+			}
+			json	+= "}";
+			Member root(json.c_str(),json.length());
+			ok	= Parse(root,keys) && ok;
+			for( size_t i=0; i+1<root.members.size(); i+=2 )
+			{
+				size_t const k	= (size_t)root.members[i+1].GetValue().AsInt();
+				if( seen[t][k] == KeyNone )			seen[t][k] = root.members[i].key;
+				else if( seen[t][k] != root.members[i].key )	ok = false;
+			}
+		}
+		parsed[t]	= ok ? 1 : 0;
+	};
+	std::vector<std::thread> workers;
+	for( size_t t=0; t<threads; ++t )
+	{
+		workers.push_back(std::thread(Work,t));
+	}
+	for( std::thread& worker : workers )
+	{
+		worker.join();
+	}
+
+	CHECK(keys.Size() == distinct);
+	std::vector<bool> used(distinct + 1,false);
+	for( size_t k=0; k<distinct; ++k )
+	{
+		KeyId const id	= seen[0][k];
+		CHECK(id != KeyNone && id <= distinct && !used[id]);
+		used[id]	= true;
+		std::string const name	= "key" + std::to_string(k);
+		CHECK(keys.Lookup(name.c_str()) == id);
+		CHECK(*keys.Name(id) == name);
+		for( size_t t=0; t<threads; ++t )
+		{
+			CHECK(parsed[t]);
+			CHECK(seen[t][k] == id);
+		}
+	}
+}
@@ -0,0 +1,43 @@
+#define JSONIC_IMPLEMENTATION
+#include "Test.h"
+
+namespace test
+{
+	static int	failures	= 0;
+
+	std::vector<Case>& Cases()
+	{
+		static std::vector<Case> cases;
+		return cases;
+	}
+
+	void Fail(char const* file,int line,char const* expression)
+	{
+		fprintf(stderr,"%s:%d: CHECK(%s) failed\n",file,line,expression);
+		++failures;
+	}
+}
+
+// Runs every case, or only those of the suite named by the first argument
+int main(int argc,char** argv)
+{
+	char const* suite	= argc > 1 ? argv[1] : nullptr;
+	size_t run			= 0;
+	for( test::Case const& c : test::Cases() )
+	{
+		if( suite && strcmp(suite,c.suite) != 0 )
+		{
+			continue;
+		}
+		int const before	= test::failures;
+		c.function();
+		printf("%s %s.%s\n",test::failures == before ? "ok  " : "FAIL",c.suite,c.name);
+		++run;
+	}
+	if( run == 0 )
+	{
+		fprintf(stderr,"no tests in suite %s\n",suite ? suite : "");
+		return 1;
+	}
+	return test::failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+#include "Test.h"
+
+using namespace jsonic;
+
+static bool ParseNodes(char const* json,std::vector<Node>& nodes,size_t capacity,size_t depthCapacity,size_t* count)
+{
+	std::vector<uint32_t> depth(depthCapacity + 1);
+	nodes.assign(capacity + 1,Node());
+	return Parse(json,strlen(json),NodeSpan{ nodes.data(), capacity },DepthSpan{ depth.data(), depthCapacity },count);
+}
+
+TEST(nodes,Layout)
+{
+	char const json[]	= "{\"a\":[1,2,{\"b\":null}],\"c\":\"x\",\"d\":{}}";
+	std::vector<Node> nodes;
+	size_t count	= 0;
+	CHECK(ParseNodes(json,nodes,64,8,&count));
+	CHECK(count == 12);
+
+	Node const& root	= nodes[0];
+	CHECK(root.type == OBJECT && root.count == 3 && root.size == 12);
+	CHECK(root.str == json && root.len == sizeof(json) - 1);
+
+	Node const* a	= root.Find("a");
+	CHECK(a == &nodes[2] && a->type == ARRAY && a->count == 3 && a->size == 6);
+	CHECK(std::string(a->str,a->len) == "[1,2,{\"b\":null}]");
+	CHECK(nodes[1].type == KEY && std::string(nodes[1].str,nodes[1].len) == "\"a\"");
+
+	// Next skips whole subtrees
+	Node const* e	= a + 1;
+	CHECK(e->type == VALUE && e->GetValue().AsDouble() == 1);
+	e	= e->Next();
+	CHECK(e->GetValue().AsDouble() == 2);
+	e	= e->Next();
+	CHECK(e->type == OBJECT && e->count == 1 && e->size == 3 && e->Find("b")->GetValue().IsNull());
+	CHECK(e->Next() == &nodes[8]);	// key "c"
+	CHECK(a->Next() == &nodes[8]);
+
+	CHECK(std::string(root.Find("c")->GetValue().AsString()) == "x");
+	Node const* d	= root.Find("d");
+	CHECK(d->type == OBJECT && d->count == 0 && d->size == 1 && d->Next() == &nodes[12]);
+	CHECK(root.Find("missing") == nullptr);
+	CHECK(root.Next() == &nodes[count]);
+}
+
+// Every capacity below the node count fails without writing past the span, the exact count succeeds
+TEST(nodes,Capacity)
+{
+	char const json[]	= "{\"a\":[1,2,{\"b\":null}],\"c\":\"x\"}";
+	std::vector<Node> nodes;
+	size_t count	= 0;
+	CHECK(ParseNodes(json,nodes,64,8,&count));
+	size_t const needed	= count;
+	for( size_t capacity=0; capacity<needed; ++capacity )
+	{
+		count	= 99;
+		CHECK(!ParseNodes(json,nodes,capacity,8,&count));
+		CHECK(count == 0);
+		CHECK(nodes[capacity].str == nullptr);	// the guard node after the span is untouched
+	}
+	CHECK(ParseNodes(json,nodes,needed,8,&count) && count == needed);
+}
+
+TEST(nodes,Depth)
+{
+	char const json[]	= "[[{\"a\":[[]]}],{}]";
+	std::vector<Node> nodes;
+	size_t count	= 0;
+	CHECK(ParseNodes(json,nodes,64,5,&count));
+	CHECK(!ParseNodes(json,nodes,64,4,&count));
+	CHECK(ParseNodes(json,nodes,64,6,&count));
+	// Scalars need no depth at all
+	CHECK(ParseNodes("17",nodes,1,0,&count) && count == 1);
+	CHECK(!ParseNodes("[]",nodes,1,0,&count));
+}
+
+// The doc comment promises len/2 + 1 nodes and len/2 depth entries are always enough
+TEST(nodes,Bounds)
+{
+	char const* const documents[]	= { "0", "[]", "{}", "[0]", "[0,0]", "[0,0,0,0,0,0,0]", "[[[[[[]]]]]]", "[[[[[[0]]]]]]",
+										"{\"\":0}", "{\"\":0,\"\":0,\"\":0}", "[{},{},{}]", "[[],[],[[]]]", "{\"\":[{\"\":{}}]}",
+										"\"\"", "[\"\",\"\"]", " [ 0 , 0 ] " };
+	for( char const* json : documents )
+	{
+		size_t const len	= strlen(json);
+		std::vector<Node> nodes;
+		size_t count	= 0;
+		CHECK(ParseNodes(json,nodes,len/2 + 1,len/2,&count));
+		CHECK(count > 0 && count <= len/2 + 1);
+	}
+	// The tightest cases use every node and depth entry
+	std::vector<Node> nodes;
+	size_t count	= 0;
+	CHECK(ParseNodes("[0,0,0,0,0]",nodes,6,5,&count) && count == 6);
+	CHECK(ParseNodes("[[[[[]]]]]",nodes,5,5,&count) && count == 5);
+}
+
+TEST(nodes,Malformed)
+{
+	char const* const documents[]	= { "", " ", "[", "]", "[1,]", "[,1]", "[1 2]", "{\"a\"}", "{\"a\":}", "{\"a\":1,}", "{1:2}",
+										"[}", "{]", "[\"abc]", "[\"\\\"]", "[]]", "[] x", "[tru]", "[nul]", "[-]", "[1.]", "[.5]",
+										"[1e]", "[1e+]", "[01]", "[-01]", "[00]", "[0123]", "{\"a\":01}", "[+1]" };
+	for( char const* json : documents )
+	{
+		std::vector<Node> nodes;
+		size_t count	= 99;
+		CHECK(!ParseNodes(json,nodes,64,8,&count));
+		CHECK(count == 0);
+	}
+	for( char const* json : { "[0]", "[-0]", "[0.5]", "[-0.0e-1]", "[0e5]", "[10]", "[100]", "[true,false,null]", "[\"\\\\\"]" } )
+	{
+		std::vector<Node> nodes;
+		size_t count	= 0;
+		CHECK(ParseNodes(json,nodes,64,8,&count));
+	}
+}
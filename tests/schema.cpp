@@ -0,0 +1,189 @@
+#include "Test.h"
+
+using namespace jsonic;
+
+static bool Compile(Schema& schema,char const* json)
+{
+	std::string error;
+	bool const ok	= schema.Compile(json,strlen(json),&error);
+	CHECK(ok && error.empty());
+	return ok;
+}
+
+static bool Validate(Schema const& schema,char const* json,std::string* error=nullptr)
+{
+	Member root(json,strlen(json));
+	SchemaValidator validator(schema);
+	bool const ok	= Parse(root,validator);
+
+	// The event parser must agree with validation during the tree build
+	SchemaValidator events(schema);
+	CHECK(ParseEvents(json,strlen(json),events) == ok);
+	if( error )	*error = validator.Error();
+	return ok;
+}
+
+// Extra closing brackets once the root is complete have no open container to end
+TEST(schema,OverClosed)
+{
+	Schema schema;
+	Compile(schema,"true");
+	char const* const invalid[]	= { "{}}", "[]]", "{\"a\":[1]}]}", "[{}]}", "[[]]]" };
+	for( char const* doc : invalid )
+	{
+		CHECK(!Validate(schema,doc));
+	}
+	CHECK(Validate(schema,"{}"));
+	CHECK(Validate(schema,"[[],{}]"));
+
+	SchemaValidator validator(schema);
+	CHECK(!validator.OnEndObject());
+	CHECK(!validator.OnEndArray());
+	CHECK(!validator.OnKey("a",1));
+}
+
+TEST(schema,BooleanSchemas)
+{
+	Schema any;
+	Schema none;
+	Compile(any," true ");
+	Compile(none,"false");
+	CHECK(Validate(any,"{\"a\":[1,\"x\",null]}"));
+	CHECK(!Validate(none,"{}"));
+	CHECK(!Validate(none,"[]"));
+
+	Schema number;
+	CHECK(!number.Compile("5",1));
+	CHECK(!number.Compiled());
+}
+
+// Draft 4 boolean exclusive flags and draft 6 numeric bounds, in either key order
+// Values are array elements, since the tree parser takes no scalar root
+TEST(schema,KeyOrder)
+{
+	char const* const bounds[]	=
+	{
+		"{\"minimum\":5,\"exclusiveMinimum\":true,\"maximum\":9,\"exclusiveMaximum\":true}",
+		"{\"exclusiveMinimum\":true,\"minimum\":5,\"exclusiveMaximum\":true,\"maximum\":9}",
+		"{\"exclusiveMinimum\":5,\"exclusiveMaximum\":9}",
+		"{\"minimum\":5,\"exclusiveMinimum\":5,\"exclusiveMaximum\":9,\"maximum\":9}",
+		"{\"exclusiveMinimum\":5,\"minimum\":4,\"maximum\":10,\"exclusiveMaximum\":9}",
+	};
+	for( char const* items : bounds )
+	{
+		std::string const json	= "{\"items\":" + test::Str(items) + "}";
+		Schema schema;
+		Compile(schema,json.c_str());
+		CHECK(!Validate(schema,"[5]"));
+		CHECK(Validate(schema,"[5.5,8.5]"));
+		CHECK(!Validate(schema,"[9]"));
+	}
+
+	Schema inclusive;
+	Compile(inclusive,"{\"items\":{\"exclusiveMinimum\":false,\"minimum\":5,\"maximum\":9}}");
+	CHECK(Validate(inclusive,"[5,9]"));
+	CHECK(!Validate(inclusive,"[4]"));
+}
+
+// The first violation and its JSON Pointer, which both parsers must report the same way
+static std::string Error(Schema const& schema,char const* json)
+{
+	std::string error;
+	CHECK(!Validate(schema,json,&error));
+	SchemaValidator events(schema);
+	CHECK(!ParseEvents(json,strlen(json),events));
+	CHECK(events.Error() == error);
+	return error;
+}
+
+TEST(schema,Errors)
+{
+	Schema schema;
+	Compile(schema,"{\"type\":\"object\",\"required\":[\"id\"],\"properties\":{"
+						"\"id\":{\"type\":\"integer\",\"minimum\":1},"
+						"\"name\":{\"type\":\"string\",\"minLength\":2,\"maxLength\":3},"
+						"\"color\":{\"enum\":[\"red\",1,null,false]},"
+						"\"a/b~\":{\"type\":[\"number\",\"null\"]},"
+						"\"rows\":{\"type\":\"array\",\"items\":{\"type\":\"object\",\"required\":[\"price\"],\"properties\":{\"price\":{\"maximum\":10}}}}}}");
+	CHECK(Validate(schema,"{\"id\":1,\"name\":\"\xc3\xa9\xc3\xa9\xc3\xa9\",\"color\":null,\"a/b~\":2.5,\"rows\":[{\"price\":10},{\"price\":-1,\"x\":{}}],\"other\":[true]}"));
+	CHECK(Validate(schema,"{\"id\":2,\"color\":1,\"a/b~\":null}"));
+
+	CHECK(Error(schema,"[]") == ": wrong type");
+	CHECK(Error(schema,"{\"name\":\"ab\"}") == ": missing required property \"id\"");
+	CHECK(Error(schema,"{\"id\":1.5}") == "/id: wrong type");
+	CHECK(Error(schema,"{\"id\":\"1\"}") == "/id: wrong type");
+	CHECK(Error(schema,"{\"id\":0}") == "/id: below minimum");
+	CHECK(Error(schema,"{\"id\":1,\"name\":\"\xc3\xa9\"}") == "/name: shorter than minLength");
+	CHECK(Error(schema,"{\"id\":1,\"name\":\"abcd\"}") == "/name: longer than maxLength");
+	CHECK(Error(schema,"{\"id\":1,\"name\":7}") == "/name: wrong type");
+	CHECK(Error(schema,"{\"id\":1,\"color\":\"blue\"}") == "/color: not one of the enum values");
+	CHECK(Error(schema,"{\"id\":1,\"color\":true}") == "/color: not one of the enum values");
+	CHECK(Error(schema,"{\"id\":1,\"color\":2}") == "/color: not one of the enum values");
+	CHECK(Error(schema,"{\"id\":1,\"color\":[\"red\"]}") == "/color: not one of the enum values");
+	CHECK(Error(schema,"{\"id\":1,\"a/b~\":\"x\"}") == "/a~1b~0: wrong type");
+	CHECK(Error(schema,"{\"id\":1,\"rows\":{}}") == "/rows: wrong type");
+	CHECK(Error(schema,"{\"id\":1,\"rows\":[{\"price\":1},7]}") == "/rows/1: wrong type");
+	CHECK(Error(schema,"{\"id\":1,\"rows\":[{\"price\":1},{\"price\":2},{\"price\":11}]}") == "/rows/2/price: above maximum");
+	CHECK(Error(schema,"{\"id\":1,\"rows\":[{\"price\":1},{\"cost\":2}]}") == "/rows/1: missing required property \"price\"");
+
+	// A validator is reused after Reset
+	SchemaValidator validator(schema);
+	char const bad[]	= "{\"id\":0}";
+	char const good[]	= "{\"id\":3}";
+	CHECK(!ParseEvents(bad,sizeof(bad) - 1,validator));
+	validator.Reset();
+	CHECK(validator.Error().empty());
+	CHECK(ParseEvents(good,sizeof(good) - 1,validator));
+}
+
+TEST(schema,CompileErrors)
+{
+	char const* const invalid[]	= { "{\"type\":\"text\"}", "{\"minimum\":\"1\"}", "{\"minLength\":-1}", "{\"maxLength\":1.5}",
+									"{\"items\":[{}]}", "{\"properties\":[]}", "{\"required\":[1]}", "{\"enum\":[{}]}", "{\"enum\":1}",
+									"{\"properties\":{\"a\":5}}", "{", "[]" };
+	for( char const* json : invalid )
+	{
+		Schema schema;
+		std::string error;
+		CHECK(!schema.Compile(json,strlen(json),&error));
+		CHECK(!error.empty() && !schema.Compiled());
+	}
+}
+
+// Integers above 2^53 are compared exactly, not through a double
+TEST(schema,LargeIntegers)
+{
+	Schema enumeration;
+	Compile(enumeration,"{\"items\":{\"enum\":[9007199254740993,-9223372036854775808,18446744073709551615,2.5]}}");
+	CHECK(Validate(enumeration,"[9007199254740993,-9223372036854775808,18446744073709551615,2.5,25e-1]"));
+	CHECK(!Validate(enumeration,"[9007199254740992]"));
+	CHECK(!Validate(enumeration,"[9007199254740994]"));
+	CHECK(!Validate(enumeration,"[-9223372036854775807]"));
+	CHECK(!Validate(enumeration,"[18446744073709551614]"));
+
+	Schema bounds;
+	Compile(bounds,"{\"items\":{\"minimum\":-9007199254740993,\"maximum\":9007199254740992}}");
+	CHECK(Validate(bounds,"[9007199254740992,-9007199254740993,0,9007199254740991.5]"));
+	CHECK(!Validate(bounds,"[9007199254740993]"));
+	CHECK(!Validate(bounds,"[-9007199254740994]"));
+	CHECK(!Validate(bounds,"[18446744073709551615]"));
+
+	Schema exclusive;
+	Compile(exclusive,"{\"items\":{\"exclusiveMinimum\":1234567890123456788,\"exclusiveMaximum\":1234567890123456790}}");
+	CHECK(Validate(exclusive,"[1234567890123456789]"));
+	CHECK(!Validate(exclusive,"[1234567890123456788]"));
+	CHECK(!Validate(exclusive,"[1234567890123456790]"));
+
+	// Binary integers are exact as well
+	for( Format format : { FormatMsgPack, FormatCBOR } )
+	{
+		for( char const* json : { "[9007199254740993]", "[9007199254740992]" } )
+		{
+			std::string packed;
+			CHECK(Transcode(json,strlen(json),FormatJSON,format,packed));
+			Member root(packed.data(),packed.size(),format);
+			SchemaValidator validator(bounds);
+			CHECK(Parse(root,validator) == (json[16] == '2'));
+		}
+	}
+}
@@ -0,0 +1,46 @@
+#include "Test.h"
+
+using namespace jsonic;
+
+TEST(stats,Counts)
+{
+	char const json[]	= "{\"a\":[1,2,{\"b\":\"x\\n\"}],\"c\":{}}";
+	Member root(json,sizeof(json) - 1);
+	ParseStats stats;
+	size_t allocated	= 0;
+	stats.onAllocate	= [&](size_t size) { allocated += size; };
+	CHECK(Parse(root,&stats));
+	CHECK(stats.objects == 3);
+	CHECK(stats.arrays == 1);
+	CHECK(stats.keys == 3);
+	CHECK(stats.values == 3);
+	CHECK(stats.maxDepth == 3);
+	CHECK(stats.escapedStrings == 1);
+	CHECK(stats.bytesScanned == sizeof(json) - 1);
+	CHECK(stats.allocations > 0 && stats.allocatedBytes == allocated);
+	CHECK(stats.scanTime == 0 && stats.buildTime == 0 && stats.decodeTime == 0);
+
+	// Counts accumulate across documents
+	Member again(json,sizeof(json) - 1);
+	CHECK(Parse(again,&stats));
+	CHECK(stats.objects == 6 && stats.bytesScanned == 2 * (sizeof(json) - 1));
+}
+
+TEST(stats,Phases)
+{
+	std::string json	= "[";
+	for( int i=0; i<10000; ++i )
+	{
+		json	+= i ? ",{\"id\":" : "{\"id\":";
+		json	+= std::to_string(i) + ",\"v\":[1.5,\"s\"]}";
+	}
+	json	+= "]";
+
+	ParseStats stats;
+	stats.timePhases	= true;
+	stats.decodeValues	= true;
+	Member root(json.c_str(),json.length());
+	CHECK(Parse(root,&stats));
+	CHECK(stats.scanTime > 0 && stats.buildTime > 0 && stats.decodeTime > 0);
+	CHECK(stats.objects == 10000 && stats.arrays == 10001);
+}
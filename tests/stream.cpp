@@ -0,0 +1,60 @@
+#include "Recorder.h"
+
+using namespace jsonic;
+
+static char const Document[]	= " {\"key\\\"s\":[1,-2,18446744073709551615,2.5e-3,true,false,null],"
+								  "\"text\":\"tab\\t \\u00e9 \\ud83d\\ude00\",\"empty\":{},\"list\":[[],[{}]]} ";
+
+static std::string Expected()
+{
+	Recorder whole;
+	CHECK(ParseEvents(Document,sizeof(Document) - 1,whole));
+	return whole.log;
+}
+
+// Splitting the input at any point must give the same events as parsing it whole
+TEST(stream,SplitPoints)
+{
+	std::string const expected	= Expected();
+	size_t const len	= sizeof(Document) - 1;
+	for( size_t split=0; split<=len; ++split )
+	{
+		Recorder pieces;
+		EventStream<Recorder> stream(pieces);
+		CHECK(stream.Feed(Document,split));
+		CHECK(stream.Feed(Document + split,len - split));
+		CHECK(stream.Finish());
+		CHECK(pieces.log == expected);
+	}
+
+	Recorder bytes;
+	EventStream<Recorder> stream(bytes);
+	for( size_t i=0; i<len; ++i )
+	{
+		CHECK(stream.Feed(Document + i,1));
+	}
+	CHECK(stream.Finish());
+	CHECK(bytes.log == expected);
+}
+
+TEST(stream,Documents)
+{
+	char const lines[]	= "{\"a\":1}\n[2]\n\n\"three\"\n4 5";
+	Recorder recorder;
+	EventStream<Recorder> stream(recorder,true);
+	CHECK(stream.Feed(lines,sizeof(lines) - 1));
+	CHECK(stream.Finish());
+	CHECK(recorder.documents == 5);
+	CHECK(recorder.log == "{ k:a i:1 } | [ i:2 ] | s:three | i:4 | i:5 | ");
+}
+
+TEST(stream,Errors)
+{
+	char const* const invalid[]	= { "{\"a\":1", "[1,]", "{\"a\" 1}", "[1]]", "\"open", "[tru]", "{}{}" };
+	for( char const* doc : invalid )
+	{
+		Recorder recorder;
+		EventStream<Recorder> stream(recorder);
+		CHECK(!(stream.Feed(doc,strlen(doc)) && stream.Finish()));
+	}
+}
@@ -0,0 +1,138 @@
+#include "Test.h"
+#include <random>
+
+using namespace jsonic;
+
+static Value Scalar(char const* json)
+{
+	Member m(json,strlen(json));
+	m.type	= VALUE;
+	return m.GetValue();
+}
+
+TEST(values,Numbers)
+{
+	CHECK(Scalar("0").AsDouble() == 0);
+	CHECK(Scalar("-12.5").AsDouble() == -12.5);
+	CHECK(Scalar(" 1e22 ").AsDouble() == 1e22);
+	CHECK(Scalar("0.30000000000000004").AsDouble() == 0.30000000000000004);
+	CHECK(Scalar("2.2250738585072014e-308").AsDouble() == 2.2250738585072014e-308);
+	CHECK(Scalar("1.7976931348623157e308").AsDouble() == 1.7976931348623157e308);
+}
+
+// Mantissas beyond 2^53 take the Eisel-Lemire path and must round exactly like strtod
+TEST(values,LongMantissas)
+{
+	char const* const numbers[]	= { "0.10000000000000001", "-3.1415926535897931", "9007199254740993", "9007199254740995",
+									"18446744073709551615", "1.2345678901234567e-40", "9.8765432109876543e60",
+									"12345678901234567890e-64", "1e23", "4.9406564584124654e-324", "8.9884656743115795e307" };
+	for( char const* sz : numbers )
+	{
+		double d	= 0;
+		CHECK(ParseDouble(sz,strlen(sz),&d));
+		CHECK(d == strtod(sz,nullptr));
+	}
+}
+
+// Random mantissas of up to 19 digits with every exponent of the 5^q table, q in [-64,64]
+TEST(values,RandomAgainstStrtod)
+{
+	std::mt19937_64 random(20261018);
+	char sz[64];
+	for( int i=0; i<200000; ++i )
+	{
+		uint64_t mantissa	= random();
+		int const digits	= 1 + (int)(random() % 19);
+		for( int k=digits; k<20; ++k )	mantissa /= 10;
+		int const q			= -64 + (int)(random() % 129);
+		if( i % 2 )
+		{
+			snprintf(sz,sizeof(sz),"%llue%d",(unsigned long long)mantissa,q);
+		}
+		else
+		{
+			// Written with a fraction, the exponent grows by the fraction digits so the value is unchanged
+			std::string const text	= std::to_string(mantissa);
+			size_t const point		= 1 + random() % text.length();
+			int const e				= q + (int)(text.length() - point);
+			snprintf(sz,sizeof(sz),"%s%s%s%se%d",random() % 2 ? "-" : "",text.substr(0,point).c_str(),point < text.length() ? "." : "",text.substr(point).c_str(),e);
+		}
+		double d	= 0;
+		CHECK(ParseDouble(sz,strlen(sz),&d));
+		CHECK(d == strtod(sz,nullptr));
+	}
+	// Shortest round trip text of random doubles
+	for( int i=0; i<100000; ++i )
+	{
+		uint64_t bits	= random();
+		double value;
+		memcpy(&value,&bits,sizeof(value));
+		if( value != value || value - value != 0 )	continue;
+		snprintf(sz,sizeof(sz),"%.17g",value);
+		double d	= 0;
+		CHECK(ParseDouble(sz,strlen(sz),&d));
+		CHECK(d == value);
+	}
+}
+
+// JSON has no leading zeros, a lone 0 is the only integer part that starts with one
+TEST(values,LeadingZeros)
+{
+	double d;
+	int64_t i;
+	uint64_t u;
+	for( char const* sz : { "01", "-01", "00", "00.5", "012e3", "-00", "0123" } )
+	{
+		size_t const len	= strlen(sz);
+		CHECK(!ParseDouble(sz,len,&d));
+		CHECK(!ParseInteger(sz,len,&i));
+		CHECK(!ParseUnsigned(sz,len,&u));
+
+		std::string const json	= "[1," + std::string(sz) + "]";
+		for( int flags : { (int)ParseDefault, (int)ParseCompactArrays } )
+		{
+			Member root(json.c_str(),json.length());
+			if( !Parse(root,flags) )	continue;
+			std::vector<double> doubles;
+			std::vector<int64_t> integers;
+			CHECK(!root.GetArray(doubles));
+			CHECK(!root.GetArray(integers));
+		}
+	}
+	for( char const* sz : { "0", "-0", "0.5", "0e1", "-0.0", "10", "100.05" } )
+	{
+		CHECK(ParseDouble(sz,strlen(sz),&d) && d == strtod(sz,nullptr));
+	}
+	CHECK(ParseInteger("0",1,&i) && i == 0);
+	CHECK(ParseUnsigned("0",1,&u) && u == 0);
+}
+
+// Numbers that do not fit a double are errors, not infinity or zero
+TEST(values,OutOfRange)
+{
+	CHECK(Scalar("1e400").GetType() == ValueError);
+	CHECK(Scalar("-1e400").GetType() == ValueError);
+	CHECK(Scalar("1e-400").GetType() == ValueError);
+
+	double d	= 0;
+	CHECK(!ParseDouble("1e400",5,&d));
+	CHECK(!ParseDouble("1e-400",6,&d));
+	CHECK(ParseDouble("1e300",5,&d) && d == 1e300);
+}
+
+TEST(values,Arrays)
+{
+	char const json[]	= "{\"a\":[1,2.5,-3e2,4],\"b\":[1,\"x\"],\"c\":[1e400]}";
+	for( int flags : { (int)ParseDefault, (int)ParseCompactArrays } )
+	{
+		Member root(json,sizeof(json) - 1);
+		CHECK(Parse(root,flags));
+		std::vector<double> doubles;
+		CHECK(root.Find("a")->GetArray(doubles));
+		CHECK(doubles.size() == 4 && doubles[1] == 2.5 && doubles[2] == -300);
+		CHECK(root.Find("a")->Size() == 4);
+		CHECK(root.Find("a")->GetValue(3).AsDouble() == 4);
+		CHECK(!root.Find("b")->GetArray(doubles));
+		CHECK(!root.Find("c")->GetArray(doubles));
+	}
+}